@@ -1,9 +1,14 @@
 {
+  "includes": ["release.gypi"],
+  "variables": {
+    # 1 = also build build/<config>/opus_bench (src/bench/opus-bench.cc)
+    "opus_bench%": 0
+  },
   "targets": [
     {
       "target_name": "binding", # internal .node filename
 
-      "dependencies": ["libopus/binding.gyp:libopus"],
+      "dependencies": ["libopus/binding.gyp:libopus", "opus_analysis"],
 
       "cflags!": ["-fno-exceptions"],
       "cflags_cc!": ["-fno-exceptions"],
@@ -44,8 +49,57 @@
       ],
 
       "sources": [
-        "src/node-opus.cc"
+        "src/node-opus.cc",
+        "src/ladder-encoder.cc",
+        "src/clip-cache.cc",
+        "src/codec-pool.cc",
+        "src/complexity-governor.cc",
+        "src/custom-encoder.cc",
+        "src/encoder-farm.cc",
+        "src/file-codec.cc",
+        "src/mapped-file.cc",
+        "src/ogg-edit.cc",
+        "src/ogg-opus.cc",
+        "src/ogg-recorder.cc",
+        "src/pcm-ingest.cc",
+        "src/rate-controller.cc",
+        "src/rtp.cc",
+        "src/seek-index.cc",
+        "src/shared-ring.cc",
+        "src/udp-transport.cc",
+        "src/worker-pool.cc"
       ]
+    },
+    {
+      # The bridge to libopus' private analysis.c. It is the only source that
+      # needs the libopus internal headers, so they stay out of the addon.
+      "target_name": "opus_analysis",
+      "type": "static_library",
+      "dependencies": ["libopus/binding.gyp:libopus"],
+      "cflags": ["-fPIC"],
+      "include_dirs": [
+        "libopus/config/<(OS)/<(target_arch)",
+        "libopus/opus/include",
+        "libopus/opus/celt",
+        "libopus/opus/src"
+      ],
+      "sources": ["src/opus-analysis.c"]
     }
+  ],
+  "conditions": [
+    [
+      "opus_bench==1",
+      {
+        "targets": [
+          {
+            # libopus on its own, without Node-API in the way
+            "target_name": "opus_bench",
+            "type": "executable",
+            "dependencies": ["libopus/binding.gyp:libopus"],
+            "sources": ["src/bench/opus-bench.cc"]
+          }
+        ]
+      }
+    ]
   ]
 }
@@ -1,15 +1,26 @@
 {
-    "variables": {"target_arch%": "x64"},
+    "includes": ["../release.gypi"],
+    "variables": {
+        "target_arch%": "x64",
+        # 1 = build the opus_custom_* API (CELT custom modes, any frame size)
+        "opus_custom_modes%": 0,
+        # 1 = fixed-point codec (FIXED_POINT, silk/fixed encoder) for cores
+        # without a fast FPU; the JS API is the same
+        "opus_fixed_point%": 0,
+        # 1 = build the libopus 1.5 DNN features (DRED, deep PLC, OSCE) with
+        # their weights compiled in
+        "opus_dnn%": 0,
+    },
     "target_defaults": {
-        "default_configuration": "Debug",
-        "configuration": {
+        "default_configuration": "Release",
+        "configurations": {
             "Debug": {
                 "defines": ["DEBUG", "_DEBUG"],
-                "msvs_settings": {"VSSLCompilerTool": {"RuntimeLibrary": 1}},
+                "msvs_settings": {"VCCLCompilerTool": {"RuntimeLibrary": 1}},
             },
             "Release": {
                 "defines": ["NODEBUG"],
-                "msvs_settings": {"VSSLCompilerTool": {"RuntimeLibrary": 0}},
+                "msvs_settings": {"VCCLCompilerTool": {"RuntimeLibrary": 0}},
             },
         },
         "msvs_settings": {"VCLinkerTool": {"GenerateDebugInformation": "true"}}
@@ -35,34 +46,6 @@
                 "opus/src/repacketizer.c",
                 "opus/src/opus_encoder.c",
                 "opus/silk/decode_frame.c",
-                "opus/silk/float/inner_product_FLP.c",
-                "opus/silk/float/scale_vector_FLP.c",
-                "opus/silk/float/find_pred_coefs_FLP.c",
-                "opus/silk/float/schur_FLP.c",
-                "opus/silk/float/warped_autocorrelation_FLP.c",
-                "opus/silk/float/burg_modified_FLP.c",
-                "opus/silk/float/find_LPC_FLP.c",
-                "opus/silk/float/LPC_inv_pred_gain_FLP.c",
-                "opus/silk/float/scale_copy_vector_FLP.c",
-                "opus/silk/float/noise_shape_analysis_FLP.c",
-                "opus/silk/float/pitch_analysis_core_FLP.c",
-                "opus/silk/float/bwexpander_FLP.c",
-                "opus/silk/float/LTP_analysis_filter_FLP.c",
-                "opus/silk/float/LTP_scale_ctrl_FLP.c",
-                "opus/silk/float/corrMatrix_FLP.c",
-                "opus/silk/float/encode_frame_FLP.c",
-                "opus/silk/float/sort_FLP.c",
-                "opus/silk/float/find_pitch_lags_FLP.c",
-                "opus/silk/float/residual_energy_FLP.c",
-                "opus/silk/float/LPC_analysis_filter_FLP.c",
-                "opus/silk/float/autocorrelation_FLP.c",
-                "opus/silk/float/k2a_FLP.c",
-                "opus/silk/float/regularize_correlations_FLP.c",
-                "opus/silk/float/find_LTP_FLP.c",
-                "opus/silk/float/energy_FLP.c",
-                "opus/silk/float/apply_sine_window_FLP.c",
-                "opus/silk/float/wrappers_FLP.c",
-                "opus/silk/float/process_gains_FLP.c",
                 "opus/silk/stereo_quant_pred.c",
                 "opus/silk/LPC_inv_pred_gain.c",
                 "opus/silk/process_NLSFs.c",
@@ -201,10 +184,113 @@
                 "opus/include",
                 "opus/celt",
                 "opus/silk",
-                "opus/silk/float",
             ],
             "defines": ["PIC", "HAVE_CONFIG_H"],
             "conditions": [
+                [
+                    "opus_fixed_point==1",
+                    {
+                        "defines": ["FIXED_POINT"],
+                        "include_dirs": ["opus/silk/fixed"],
+                        # opus-analysis.c shares libopus' internal structs
+                        "direct_dependent_settings": {"defines": ["FIXED_POINT"]},
+                        "conditions": [
+                            [
+                                "target_arch==\"arm64\"",
+                                {
+                                    "sources": [
+                                        "opus/silk/arm/biquad_alt_neon_intr.c",
+                                        "opus/silk/arm/NSQ_del_dec_neon_intr.c",
+                                        "opus/silk/arm/NSQ_neon.c",
+                                        "opus/silk/fixed/arm/warped_autocorrelation_FIX_neon_intr.c",
+                                    ],
+                                }
+                            ],
+                        ],
+                    },
+                    {
+                        "sources": [
+                            "opus/silk/float/inner_product_FLP.c",
+                            "opus/silk/float/scale_vector_FLP.c",
+                            "opus/silk/float/find_pred_coefs_FLP.c",
+                            "opus/silk/float/schur_FLP.c",
+                            "opus/silk/float/warped_autocorrelation_FLP.c",
+                            "opus/silk/float/burg_modified_FLP.c",
+                            "opus/silk/float/find_LPC_FLP.c",
+                            "opus/silk/float/LPC_inv_pred_gain_FLP.c",
+                            "opus/silk/float/scale_copy_vector_FLP.c",
+                            "opus/silk/float/noise_shape_analysis_FLP.c",
+                            "opus/silk/float/pitch_analysis_core_FLP.c",
+                            "opus/silk/float/bwexpander_FLP.c",
+                            "opus/silk/float/LTP_analysis_filter_FLP.c",
+                            "opus/silk/float/LTP_scale_ctrl_FLP.c",
+                            "opus/silk/float/corrMatrix_FLP.c",
+                            "opus/silk/float/encode_frame_FLP.c",
+                            "opus/silk/float/sort_FLP.c",
+                            "opus/silk/float/find_pitch_lags_FLP.c",
+                            "opus/silk/float/residual_energy_FLP.c",
+                            "opus/silk/float/LPC_analysis_filter_FLP.c",
+                            "opus/silk/float/autocorrelation_FLP.c",
+                            "opus/silk/float/k2a_FLP.c",
+                            "opus/silk/float/regularize_correlations_FLP.c",
+                            "opus/silk/float/find_LTP_FLP.c",
+                            "opus/silk/float/energy_FLP.c",
+                            "opus/silk/float/apply_sine_window_FLP.c",
+                            "opus/silk/float/wrappers_FLP.c",
+                            "opus/silk/float/process_gains_FLP.c",
+                        ],
+                        "include_dirs": ["opus/silk/float"],
+                    }
+                ],
+                [
+                    "opus_custom_modes==1",
+                    {
+                        "defines": ["CUSTOM_MODES"],
+                        "direct_dependent_settings": {"defines": ["CUSTOM_MODES"]},
+                    }
+                ],
+                [
+                    "opus_dnn==1",
+                    {
+                        "sources": [
+                            # deep PLC (LPCNet features + FARGAN)
+                            "opus/dnn/burg.c",
+                            "opus/dnn/freq.c",
+                            "opus/dnn/fargan.c",
+                            "opus/dnn/fargan_data.c",
+                            "opus/dnn/lpcnet_enc.c",
+                            "opus/dnn/lpcnet_plc.c",
+                            "opus/dnn/lpcnet_tables.c",
+                            "opus/dnn/nnet.c",
+                            "opus/dnn/nnet_default.c",
+                            "opus/dnn/plc_data.c",
+                            "opus/dnn/parse_lpcnet_weights.c",
+                            "opus/dnn/pitchdnn.c",
+                            "opus/dnn/pitchdnn_data.c",
+                            # DRED
+                            "opus/dnn/dred_rdovae_enc.c",
+                            "opus/dnn/dred_rdovae_enc_data.c",
+                            "opus/dnn/dred_rdovae_dec.c",
+                            "opus/dnn/dred_rdovae_dec_data.c",
+                            "opus/dnn/dred_rdovae_stats_data.c",
+                            "opus/silk/dred_encoder.c",
+                            "opus/silk/dred_coding.c",
+                            "opus/silk/dred_decoder.c",
+                            # OSCE (LACE / NoLACE)
+                            "opus/dnn/osce.c",
+                            "opus/dnn/osce_features.c",
+                            "opus/dnn/nndsp.c",
+                            "opus/dnn/lace_data.c",
+                            "opus/dnn/nolace_data.c",
+                        ],
+                        "include_dirs": ["opus/dnn"],
+                        "defines": ["ENABLE_DEEP_PLC", "ENABLE_DRED", "ENABLE_OSCE"],
+                        "direct_dependent_settings": {"defines": ["ENABLE_DRED"]},
+                        "conditions": [
+                            ["target_arch==\"arm64\"", {"sources": ["opus/dnn/arm/nnet_neon.c"]}],
+                        ],
+                    }
+                ],
                 [
                     "target_arch==\"arm64\"",
                     {
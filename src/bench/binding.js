@@ -0,0 +1,156 @@
+// What the addon adds on top of libopus, per call: wall time, bytes allocated
+// (V8 heap and ArrayBuffer/external memory) and time spent in GC.
+//
+//   npm run bench:binding -- [--calls 20000] [--json out.json] [--against base.json]
+//                            [--native opus-bench.json]
+//
+// With --native, encode/decode rows also get `overheadNs`: the call time
+// minus opus-bench's time for the same configuration and signal.
+import fs from 'node:fs';
+import { PerformanceObserver } from 'node:perf_hooks';
+import v8 from 'node:v8';
+import vm from 'node:vm';
+import { OpusEncoder } from '../../dist/index.js';
+import { printComparison } from './compare.js';
+
+v8.setFlagsFromString('--expose-gc');
+const gc = vm.runInNewContext('gc');
+
+function arg(name) {
+  const i = process.argv.indexOf(name);
+  return i > 0 ? process.argv[i + 1] : undefined;
+}
+
+const CALLS = Number(arg('--calls') ?? 20_000);
+const RATE = 48_000;
+const CHANNELS = 2;
+const FRAME = RATE / 50;
+const OPUS_SET_COMPLEXITY = 4010;
+
+// Same signal as MakeSignal() in opus-bench.cc, so --native times line up.
+function makeSignal(rate, channels, samples) {
+  const pcm = new Int16Array(samples * channels);
+  let lcg = 1;
+  let phase = 0;
+  for (let i = 0; i < samples; i++) {
+    const t = i / rate;
+    phase += (2 * Math.PI * (140 + 40 * Math.sin(2 * Math.PI * 0.5 * t))) / rate;
+    let v = 0;
+    for (let h = 1; h <= 10; h++) v += Math.sin(h * phase) / h;
+    v *= 0.3 * Math.max(0, Math.sin(2 * Math.PI * 3 * t));
+    for (let c = 0; c < channels; c++) {
+      lcg = (Math.imul(lcg, 1664525) + 1013904223) >>> 0;
+      const noise = ((lcg >>> 8) / (1 << 24) - 0.5) * 0.02;
+      pcm[i * channels + c] = (v * (c ? 0.8 : 1.0) + noise) * 32767;
+    }
+  }
+  return pcm;
+}
+
+// Matches opus-bench's "48000Hz 2ch c10 20 ms" configuration.
+function makeCodec() {
+  const codec = new OpusEncoder(RATE, CHANNELS);
+  codec.setBitrate(48_000 * CHANNELS);
+  codec.applyEncoderCTL(OPUS_SET_COMPLEXITY, 10);
+  return codec;
+}
+
+const FRAMES = 500;
+const signal = makeSignal(RATE, CHANNELS, FRAME * FRAMES);
+const views = Array.from({ length: FRAMES }, (_, i) => signal.subarray(i * FRAME * CHANNELS, (i + 1) * FRAME * CHANNELS));
+const buffers = views.map((v) => Buffer.from(v.buffer, v.byteOffset, v.byteLength));
+const odd = views.map((v) => {
+  const bytes = new Uint8Array(v.byteLength + 1);
+  bytes.set(new Uint8Array(v.buffer, v.byteOffset, v.byteLength), 1);
+  return bytes.subarray(1);
+});
+const packets = (() => {
+  const codec = makeCodec();
+  return buffers.map((b) => codec.encode(b));
+})();
+
+// -----------------------------------------------------------------------------
+// Measurement
+// -----------------------------------------------------------------------------
+let gcCount = 0;
+let gcMs = 0;
+new PerformanceObserver((list) => {
+  for (const entry of list.getEntries()) {
+    gcCount++;
+    gcMs += entry.duration;
+  }
+}).observe({ entryTypes: ['gc'] });
+
+// GC entries reach the observer asynchronously.
+const settle = () => new Promise((resolve) => setTimeout(resolve, 10));
+
+// Bytes per call from heap growth over a run short enough to finish without
+// a collection; retried with fewer calls if one happens anyway.
+async function allocation(fn) {
+  for (let calls = 2_000; calls >= 50; calls >>= 1) {
+    gc();
+    await settle();
+    const seen = gcCount;
+    const before = process.memoryUsage();
+    for (let i = 0; i < calls; i++) fn(i);
+    const after = process.memoryUsage();
+    await settle();
+    if (gcCount === seen) {
+      return {
+        heapBytesPerCall: Math.max(0, (after.heapUsed - before.heapUsed) / calls),
+        externalBytesPerCall: Math.max(0, (after.arrayBuffers - before.arrayBuffers) / calls),
+      };
+    }
+  }
+  return { heapBytesPerCall: undefined, externalBytesPerCall: undefined };
+}
+
+async function measure(name, fn) {
+  for (let i = 0; i < 200; i++) fn(i);
+  gc();
+  await settle();
+  const gcBefore = gcMs;
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < CALLS; i++) fn(i);
+  const ns = Number(process.hrtime.bigint() - start) / CALLS;
+  await settle();
+  // Read before allocation(), whose forced gc() calls would count as well.
+  const gcMsPer1k = ((gcMs - gcBefore) / CALLS) * 1000;
+  return { name, nsPerCall: ns, ...(await allocation(fn)), gcMsPer1k };
+}
+
+const info = new Int32Array(16);
+const encoder = makeCodec();
+const decoder = makeCodec();
+const results = [
+  await measure('lookahead (accessor)', () => encoder.lookahead),
+  await measure('getBitrate()', () => encoder.getBitrate()),
+  await measure('encode(Buffer)', (i) => encoder.encode(buffers[i % FRAMES])),
+  await measure('encode(Int16Array)', (i) => encoder.encode(views[i % FRAMES])),
+  await measure('encode(odd-offset view)', (i) => encoder.encode(odd[i % FRAMES])),
+  await measure('encodeWithInfo', (i) => encoder.encodeWithInfo(buffers[i % FRAMES], info)),
+  await measure('decode(Buffer)', (i) => decoder.decode(packets[i % FRAMES])),
+];
+
+const nativePath = arg('--native');
+if (nativePath) {
+  const native = new Map(JSON.parse(fs.readFileSync(nativePath, 'utf8')).results.map((r) => [r.name, r.nsPerFrame]));
+  const config = `${RATE}Hz ${CHANNELS}ch c10 20 ms`;
+  for (const r of results) {
+    const op = r.name.match(/^(encode|decode)/)?.[1];
+    const base = op && native.get(`${op} ${config}`);
+    if (base !== undefined) r.overheadNs = r.nsPerCall - base;
+  }
+}
+
+const report = { tool: 'binding-bench', node: process.version, arch: process.arch, calls: CALLS, results };
+console.table(Object.fromEntries(results.map(({ name, ...r }) => [name, r])));
+
+const json = arg('--json');
+if (json) fs.writeFileSync(json, JSON.stringify(report, null, 2));
+
+const against = arg('--against');
+if (against) {
+  const threshold = Number(arg('--threshold') ?? 5);
+  process.exitCode = printComparison(JSON.parse(fs.readFileSync(against, 'utf8')), report, threshold) ? 1 : 0;
+}
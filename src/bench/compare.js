@@ -0,0 +1,62 @@
+// Compares two benchmark JSON files from opus-bench or bench/binding.js:
+//
+//   npm run bench:compare -- base.json new.json [--threshold 5]
+//
+// Every metric compared here is lower-is-better. A result that got worse by
+// more than `threshold` percent is a regression, and the exit code is 1.
+import fs from 'node:fs';
+import path from 'node:path';
+
+const METRICS = ['nsPerFrame', 'nsPerCall', 'overheadNs', 'heapBytesPerCall', 'externalBytesPerCall', 'gcMsPer1k'];
+
+// Small absolute changes are noise however large they are in percent.
+const FLOOR = { heapBytesPerCall: 16, externalBytesPerCall: 16, gcMsPer1k: 0.01, overheadNs: 20 };
+
+export function compare(base, current, threshold = 5) {
+  const before = new Map(base.results.map((r) => [r.name, r]));
+  const rows = [];
+  let regressions = 0;
+  for (const r of current.results) {
+    const b = before.get(r.name);
+    before.delete(r.name);
+    for (const metric of METRICS) {
+      if (typeof r[metric] !== 'number') continue;
+      if (!b || typeof b[metric] !== 'number') {
+        rows.push({ name: r.name, metric, base: undefined, new: r[metric], change: 'new' });
+        continue;
+      }
+      const delta = r[metric] - b[metric];
+      const pct = b[metric] ? (delta / b[metric]) * 100 : delta ? Infinity : 0;
+      const worse = pct > threshold && Math.abs(delta) > (FLOOR[metric] ?? 0);
+      regressions += worse;
+      rows.push({
+        name: r.name,
+        metric,
+        base: b[metric],
+        new: r[metric],
+        change: `${pct >= 0 ? '+' : ''}${pct.toFixed(1)}%${worse ? ' REGRESSION' : ''}`,
+      });
+    }
+  }
+  for (const name of before.keys()) rows.push({ name, metric: '', base: undefined, new: undefined, change: 'removed' });
+  return { rows, regressions };
+}
+
+export function printComparison(base, current, threshold) {
+  const { rows, regressions } = compare(base, current, threshold);
+  console.table(rows);
+  console.log(regressions ? `${regressions} regression(s) over ${threshold}%` : `No regressions over ${threshold}%`);
+  return regressions;
+}
+
+if (process.argv[1] && path.resolve(process.argv[1]) === import.meta.filename) {
+  const files = process.argv.slice(2).filter((a, i, all) => !a.startsWith('--') && all[i - 1] !== '--threshold');
+  if (files.length !== 2) {
+    console.error('usage: compare.js base.json new.json [--threshold percent]');
+    process.exit(2);
+  }
+  const i = process.argv.indexOf('--threshold');
+  const threshold = i > 0 ? Number(process.argv[i + 1]) : 5;
+  const [base, current] = files.map((f) => JSON.parse(fs.readFileSync(f, 'utf8')));
+  process.exit(printComparison(base, current, threshold) ? 1 : 0);
+}
@@ -0,0 +1,98 @@
+// CPU cost of the libopus 1.5 DNN features: DRED on the encoder, deep PLC,
+// DRED recovery and OSCE on the decoder. Needs a build with opus_dnn=1:
+//
+//   npx node-gyp rebuild --opus_dnn=1 && npm run build-tsup && npm run bench:dnn
+import { OpusEncoder, dnn } from '../../dist/index.js';
+
+const OPUS_SET_COMPLEXITY = 4010;
+const OPUS_SET_PACKET_LOSS_PERC = 4014;
+
+const RATE = 16_000;
+const FRAME = RATE / 50; // 20 ms
+const FRAMES = 1_500; // 30 s
+const BITRATE = 16_000;
+const LOSS_EVERY = 10; // one lost frame in ten
+
+if (!dnn) {
+  console.error('This binary was built without opus_dnn=1');
+  process.exit(1);
+}
+
+// Voiced bursts at a syllable rate with some noise, so SILK, DRED and the
+// PLC models all have something speech-like to work on.
+function speechLike(samples) {
+  const pcm = new Int16Array(samples);
+  let phase = 0;
+  for (let i = 0; i < samples; i++) {
+    const t = i / RATE;
+    const f0 = 120 + 30 * Math.sin(2 * Math.PI * 0.7 * t);
+    phase += (2 * Math.PI * f0) / RATE;
+    let v = 0;
+    for (let h = 1; h <= 12; h++) v += Math.sin(h * phase) / h;
+    const envelope = Math.max(0, Math.sin(2 * Math.PI * 4 * t));
+    pcm[i] = (v * envelope * 0.3 + (Math.random() - 0.5) * 0.02) * 32767;
+  }
+  return pcm;
+}
+
+function perFrameUs(count, fn) {
+  const start = process.hrtime.bigint();
+  fn();
+  return Number(process.hrtime.bigint() - start) / 1e3 / count;
+}
+
+const pcm = speechLike(FRAME * FRAMES);
+const frames = Array.from({ length: FRAMES }, (_, i) => pcm.subarray(i * FRAME, (i + 1) * FRAME));
+const results = [];
+
+// Encoder: DRED history depth against plain (LBRR‑capable) encoding.
+const streams = {};
+for (const dred of [0, 10, 50, 100]) {
+  const encoder = new OpusEncoder(RATE, 1, { application: 'voip' });
+  encoder.setBitrate(BITRATE);
+  encoder.applyEncoderCTL(OPUS_SET_PACKET_LOSS_PERC, 100 / LOSS_EVERY);
+  if (dred) encoder.setDredDuration(dred);
+  const packets = [];
+  const us = perFrameUs(FRAMES, () => {
+    for (const frame of frames) packets.push(encoder.encode(frame));
+  });
+  streams[dred] = packets;
+  const bytes = packets.reduce((sum, p) => sum + p.length, 0) / FRAMES;
+  results.push({ case: dred ? `encode, DRED ${dred * 10} ms` : 'encode', 'µs/frame': us, 'bytes/frame': bytes });
+}
+
+// Decoder: concealing every LOSS_EVERY‑th frame, then decoding the rest.
+function decodeCase(name, complexity, packets, conceal) {
+  const decoder = new OpusEncoder(RATE, 1);
+  decoder.applyDecoderCTL(OPUS_SET_COMPLEXITY, complexity);
+  let lostUs = 0;
+  let lost = 0;
+  let recovered = 0;
+  const us = perFrameUs(FRAMES, () => {
+    for (let i = 0; i < FRAMES - 1; i++) {
+      if (conceal && i % LOSS_EVERY === LOSS_EVERY - 1) {
+        const start = process.hrtime.bigint();
+        recovered += decoder.decodeDred(packets[i + 1], 1, FRAME).recovered;
+        lostUs += Number(process.hrtime.bigint() - start) / 1e3;
+        lost++;
+      } else {
+        decoder.decode(packets[i]);
+      }
+    }
+  });
+  results.push({
+    case: name,
+    'µs/frame': us,
+    'µs/lost frame': lost ? lostUs / lost : undefined,
+    recovered: conceal ? `${recovered}/${lost}` : undefined,
+  });
+}
+
+decodeCase('decode', 0, streams[0], false);
+decodeCase('decode + OSCE LACE', 6, streams[0], false);
+decodeCase('decode + OSCE NoLACE', 7, streams[0], false);
+decodeCase('classic PLC', 0, streams[0], true);
+decodeCase('deep PLC', 5, streams[0], true);
+decodeCase('DRED 1 s recovery', 5, streams[100], true);
+
+console.table(results);
@@ -0,0 +1,22 @@
+// Builds opus_bench (opus_bench=1) and runs it with this script's arguments.
+// --opus_* build variables go to node-gyp instead, so the build under test
+// keeps its flags:
+//
+//   npm run bench:native -- --json native.json
+//   npm run bench:native -- --opus_lto=1 --json lto.json
+import { spawnSync } from 'node:child_process';
+import path from 'node:path';
+
+const root = path.resolve(import.meta.dirname, '../..');
+const exe = path.join(root, 'build', 'Release', process.platform === 'win32' ? 'opus_bench.exe' : 'opus_bench');
+
+function run(cmd, args) {
+  const r = spawnSync(cmd, args, { cwd: root, stdio: 'inherit', shell: process.platform === 'win32' && cmd === 'npx' });
+  if (r.status !== 0) process.exit(r.status ?? 1);
+}
+
+const args = process.argv.slice(2);
+const gypVars = args.filter((a) => a.startsWith('--opus_') && a.includes('='));
+
+if (!args.includes('--no-build')) run('npx', ['node-gyp', 'rebuild', '--opus_bench=1', ...gypVars]);
+run(exe, args.filter((a) => a !== '--no-build' && !gypVars.includes(a)));
@@ -0,0 +1,226 @@
+// opus-bench.cc – raw libopus encode/decode cost, without the addon.
+//
+//   npm run bench:native -- [--seconds 2] [--repeats 3] [--filter 48000Hz] [--json out.json]
+//
+// Sweeps sample rate × channels × complexity × frame size on a deterministic
+// signal and reports the best of `repeats` passes per configuration. Compare
+// two JSON files with `npm run bench:compare -- base.json new.json`.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../opus-common.h"
+
+namespace
+{
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct Config
+{
+  opus_int32 rate;
+  int channels;
+  int complexity;
+  int frameTenthsMs; // 25 = 2.5 ms
+};
+
+struct Result
+{
+  std::string name;
+  double encodeNs{0}; // per frame, best pass
+  double decodeNs{0};
+  double bytes{0}; // mean packet size
+  double frameNs{0};
+};
+
+// -----------------------------------------------------------------------------
+// Input signal: voiced harmonics in syllable‑rate bursts plus LCG noise, so
+// both SILK and CELT get exercised. Identical on every run and build.
+// -----------------------------------------------------------------------------
+std::vector<opus_int16> MakeSignal(opus_int32 rate, int channels, size_t samples)
+{
+  std::vector<opus_int16> pcm(samples * channels);
+  uint32_t lcg = 1;
+  double phase = 0;
+  for (size_t i = 0; i < samples; ++i)
+  {
+    double t = static_cast<double>(i) / rate;
+    phase += 2 * kPi * (140 + 40 * std::sin(2 * kPi * 0.5 * t)) / rate;
+    double v = 0;
+    for (int h = 1; h <= 10; ++h)
+      v += std::sin(h * phase) / h;
+    v *= 0.3 * std::max(0.0, std::sin(2 * kPi * 3 * t));
+    for (int c = 0; c < channels; ++c)
+    {
+      lcg = lcg * 1664525u + 1013904223u;
+      double noise = (static_cast<double>(lcg >> 8) / (1 << 24) - 0.5) * 0.02;
+      pcm[i * channels + c] = static_cast<opus_int16>((v * (c ? 0.8 : 1.0) + noise) * 32767);
+    }
+  }
+  return pcm;
+}
+
+double NowNs()
+{
+  return static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool Run(const Config &c, double seconds, int repeats, Result *out, std::string *error)
+{
+  const int frame = static_cast<int>(static_cast<int64_t>(c.rate) * c.frameTenthsMs / 10000);
+  const int frames = std::max(1, static_cast<int>(seconds * c.rate / frame));
+  const int application = c.rate <= 16000 ? OPUS_APPLICATION_VOIP : OPUS_APPLICATION_AUDIO;
+
+  int err;
+  OpusEncoder *enc = opus_encoder_create(c.rate, c.channels, application, &err);
+  if (err != OPUS_OK)
+  {
+    *error = StrError(err);
+    return false;
+  }
+  OpusDecoder *dec = opus_decoder_create(c.rate, c.channels, &err);
+  if (err != OPUS_OK)
+  {
+    opus_encoder_destroy(enc);
+    *error = StrError(err);
+    return false;
+  }
+  opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY(c.complexity));
+  opus_encoder_ctl(enc, OPUS_SET_BITRATE(c.channels * (c.rate <= 16000 ? 16000 : 48000)));
+
+  const std::vector<opus_int16> pcm = MakeSignal(c.rate, c.channels, static_cast<size_t>(frames) * frame);
+  std::vector<unsigned char> packets(static_cast<size_t>(frames) * MAX_PACKET_SIZE);
+  std::vector<int> lengths(frames);
+  std::vector<opus_int16> decoded(static_cast<size_t>(frame) * c.channels);
+
+  out->encodeNs = out->decodeNs = 1e300;
+  for (int r = 0; r < repeats && error->empty(); ++r)
+  {
+    opus_encoder_ctl(enc, OPUS_RESET_STATE);
+    double start = NowNs();
+    for (int i = 0; i < frames; ++i)
+    {
+      lengths[i] = opus_encode(enc, pcm.data() + static_cast<size_t>(i) * frame * c.channels, frame,
+                               packets.data() + static_cast<size_t>(i) * MAX_PACKET_SIZE, MAX_PACKET_SIZE);
+      if (lengths[i] < 0)
+      {
+        *error = StrError(lengths[i]);
+        break;
+      }
+    }
+    out->encodeNs = std::min(out->encodeNs, (NowNs() - start) / frames);
+
+    opus_decoder_ctl(dec, OPUS_RESET_STATE);
+    start = NowNs();
+    for (int i = 0; i < frames && error->empty(); ++i)
+    {
+      int n = opus_decode(dec, packets.data() + static_cast<size_t>(i) * MAX_PACKET_SIZE, lengths[i], decoded.data(),
+                          frame, 0);
+      if (n < 0)
+        *error = StrError(n);
+    }
+    out->decodeNs = std::min(out->decodeNs, (NowNs() - start) / frames);
+  }
+
+  double bytes = 0;
+  for (int len : lengths)
+    bytes += len;
+  out->bytes = bytes / frames;
+  out->frameNs = 1e9 * frame / c.rate;
+
+  opus_encoder_destroy(enc);
+  opus_decoder_destroy(dec);
+  return error->empty();
+}
+
+const char *Arg(int argc, char **argv, const char *name)
+{
+  for (int i = 1; i + 1 < argc; ++i)
+    if (!std::strcmp(argv[i], name))
+      return argv[i + 1];
+  return nullptr;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Entry point
+// -----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  const double seconds = Arg(argc, argv, "--seconds") ? std::atof(Arg(argc, argv, "--seconds")) : 2.0;
+  const int repeats = Arg(argc, argv, "--repeats") ? std::max(1, std::atoi(Arg(argc, argv, "--repeats"))) : 3;
+  const char *filter = Arg(argc, argv, "--filter");
+  const char *jsonPath = Arg(argc, argv, "--json");
+
+  static const opus_int32 kRates[] = {8000, 16000, 24000, 48000};
+  static const int kChannels[] = {1, 2};
+  static const int kComplexities[] = {0, 5, 10};
+  static const int kFrames[] = {25, 50, 100, 200, 400, 600};
+
+  std::vector<Result> results;
+  std::printf("%s, %s\n", opus_get_version_string(),
+#ifdef FIXED_POINT
+              "fixed point"
+#else
+              "float"
+#endif
+  );
+  std::printf("%-26s %12s %12s %10s %10s\n", "config", "encode ns", "decode ns", "bytes", "enc x RT");
+  for (opus_int32 rate : kRates)
+    for (int channels : kChannels)
+      for (int complexity : kComplexities)
+        for (int tenths : kFrames)
+        {
+          char name[64];
+          std::snprintf(name, sizeof(name), "%dHz %dch c%d %g ms", rate, channels, complexity, tenths / 10.0);
+          if (filter && !std::strstr(name, filter))
+            continue;
+          Result r;
+          r.name = name;
+          std::string error;
+          if (!Run(Config{rate, channels, complexity, tenths}, seconds, repeats, &r, &error))
+          {
+            std::fprintf(stderr, "%s: %s\n", name, error.c_str());
+            return 1;
+          }
+          std::printf("%-26s %12.0f %12.0f %10.1f %9.0fx\n", name, r.encodeNs, r.decodeNs, r.bytes, r.frameNs / r.encodeNs);
+          results.push_back(r);
+        }
+
+  if (jsonPath)
+  {
+    FILE *f = std::fopen(jsonPath, "w");
+    if (!f)
+    {
+      std::perror(jsonPath);
+      return 1;
+    }
+    std::fprintf(f, "{\n  \"tool\": \"opus-bench\",\n  \"libopus\": \"%s\",\n  \"fixedPoint\": %s,\n  \"results\": [\n",
+                 opus_get_version_string(),
+#ifdef FIXED_POINT
+                 "true"
+#else
+                 "false"
+#endif
+    );
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      const Result &r = results[i];
+      std::fprintf(f,
+                   "    { \"name\": \"encode %s\", \"nsPerFrame\": %.1f, \"bytesPerFrame\": %.1f },\n"
+                   "    { \"name\": \"decode %s\", \"nsPerFrame\": %.1f }%s\n",
+                   r.name.c_str(), r.encodeNs, r.bytes, r.name.c_str(), r.decodeNs, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+// Encode and decode cost per 20 ms frame for a few typical configurations,
+// labelled with the build. Save one build's run and compare another to it:
+//
+//   npm run bench:throughput -- --save float.json
+//   npx node-gyp rebuild --opus_fixed_point=1
+//   npm run bench:throughput -- --against float.json
+//
+// `npm run pgo` uses the same runs to report what LTO + PGO gained.
+import fs from 'node:fs';
+import os from 'node:os';
+import { OpusEncoder, fixedPoint } from '../../dist/index.js';
+
+const OPUS_SET_COMPLEXITY = 4010;
+const SECONDS = 20;
+
+const CASES = [
+  { name: 'voip 16k mono 16 kb/s', rate: 16_000, channels: 1, bitrate: 16_000, application: 'voip' },
+  { name: 'voip 48k mono 32 kb/s', rate: 48_000, channels: 1, bitrate: 32_000, application: 'voip' },
+  { name: 'audio 48k stereo 128 kb/s', rate: 48_000, channels: 2, bitrate: 128_000, application: 'audio' },
+];
+const COMPLEXITIES = [0, 5, 10];
+
+function arg(name) {
+  const i = process.argv.indexOf(name);
+  return i > 0 ? process.argv[i + 1] : undefined;
+}
+
+// Harmonic tone with a slow sweep and some noise: exercises SILK and CELT.
+function signal(rate, channels, samples) {
+  const pcm = new Int16Array(samples * channels);
+  let phase = 0;
+  for (let i = 0; i < samples; i++) {
+    phase += (2 * Math.PI * (150 + 100 * Math.sin(i / rate))) / rate;
+    let v = 0;
+    for (let h = 1; h <= 8; h++) v += Math.sin(h * phase) / h;
+    for (let c = 0; c < channels; c++) pcm[i * channels + c] = (v * 0.25 + (Math.random() - 0.5) * 0.05) * 32767;
+  }
+  return pcm;
+}
+
+function perFrameUs(count, fn) {
+  const start = process.hrtime.bigint();
+  fn();
+  return Number(process.hrtime.bigint() - start) / 1e3 / count;
+}
+
+const results = {};
+for (const c of CASES) {
+  const frame = c.rate / 50;
+  const count = SECONDS * 50;
+  const pcm = signal(c.rate, c.channels, frame * count);
+  const frames = Array.from({ length: count }, (_, i) => pcm.subarray(i * frame * c.channels, (i + 1) * frame * c.channels));
+  for (const complexity of COMPLEXITIES) {
+    const codec = new OpusEncoder(c.rate, c.channels, { application: c.application });
+    codec.setBitrate(c.bitrate);
+    codec.applyEncoderCTL(OPUS_SET_COMPLEXITY, complexity);
+    const packets = [];
+    const encodeUs = perFrameUs(count, () => {
+      for (const f of frames) packets.push(codec.encode(f));
+    });
+    const decodeUs = perFrameUs(count, () => {
+      for (const p of packets) codec.decode(p);
+    });
+    results[`${c.name}, c${complexity}`] = { encodeUs, decodeUs };
+  }
+}
+
+const build = `${process.env.OPUS_BUILD_LABEL ?? (fixedPoint ? 'fixed' : 'float')} ${process.arch} (${os.cpus()[0]?.model ?? 'unknown CPU'})`;
+const save = arg('--save');
+if (save) fs.writeFileSync(save, JSON.stringify({ build, results }, null, 2));
+
+const against = arg('--against');
+const base = against ? JSON.parse(fs.readFileSync(against, 'utf8')) : null;
+console.log(base ? `${build} against ${base.build}` : build);
+console.table(
+  Object.fromEntries(
+    Object.entries(results).map(([name, r]) => {
+      const row = { 'encode µs': r.encodeUs, 'decode µs': r.decodeUs };
+      const b = base?.results[name];
+      if (b) {
+        row['encode ×'] = r.encodeUs / b.encodeUs;
+        row['decode ×'] = r.decodeUs / b.decodeUs;
+      }
+      return [name, row];
+    }),
+  ),
+);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <napi.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// Binary arguments without Buffer conversion.
+// GetByteView() borrows the bytes of a Buffer, any TypedArray, a DataView or an
+// ArrayBuffer, including views over a SharedArrayBuffer. Nothing is allocated;
+// the view is only valid while the JS value is alive.
+// -----------------------------------------------------------------------------
+struct ByteView
+{
+  unsigned char *data{nullptr};
+  size_t length{0};
+};
+
+inline bool GetByteView(Napi::Env env, Napi::Value value, ByteView *view)
+{
+  bool is = false;
+  void *data = nullptr;
+  if (napi_is_typedarray(env, value, &is) == napi_ok && is)
+  {
+    // Buffers are Uint8Arrays. Use the raw call: TypedArray::ArrayBuffer()
+    // fails for SharedArrayBuffer‑backed views.
+    napi_get_typedarray_info(env, value, nullptr, nullptr, &data, nullptr, nullptr);
+    view->data = static_cast<unsigned char *>(data);
+    view->length = value.As<Napi::TypedArray>().ByteLength();
+    return true;
+  }
+  if (napi_is_dataview(env, value, &is) == napi_ok && is)
+  {
+    size_t length = 0;
+    napi_get_dataview_info(env, value, &length, &data, nullptr, nullptr);
+    view->data = static_cast<unsigned char *>(data);
+    view->length = length;
+    return true;
+  }
+  if (napi_is_arraybuffer(env, value, &is) == napi_ok && is)
+  {
+    size_t length = 0;
+    napi_get_arraybuffer_info(env, value, &data, &length);
+    view->data = static_cast<unsigned char *>(data);
+    view->length = length;
+    return true;
+  }
+  return false;
+}
+
+// 16‑bit PCM from a view that may start at an odd byte offset: the view itself
+// when it is aligned, otherwise a copy in `scratch`.
+inline const opus_int16 *AlignedPcm(const ByteView &view, std::vector<opus_int16> *scratch)
+{
+  if (reinterpret_cast<uintptr_t>(view.data) % alignof(opus_int16) == 0)
+    return reinterpret_cast<const opus_int16 *>(view.data);
+  scratch->resize(view.length / sizeof(opus_int16));
+  std::memcpy(scratch->data(), view.data, scratch->size() * sizeof(opus_int16));
+  return scratch->data();
+}
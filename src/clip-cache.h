@@ -0,0 +1,63 @@
+#pragma once
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// ClipCache – LRU of encoded packet sequences keyed by PCM content.
+// A clip is encoded from a freshly reset encoder state and the encoder is reset
+// again afterwards, so a cache hit is bit‑identical to re‑encoding and leaves
+// the encoder exactly as a miss would.
+// -----------------------------------------------------------------------------
+class ClipCacheWrap : public Napi::ObjectWrap<ClipCacheWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  ClipCacheWrap(const Napi::CallbackInfo &);
+
+private:
+  struct Key
+  {
+    uint64_t pcmHash;
+    uint64_t configHash;
+    uint64_t pcmBytes;
+    bool operator==(const Key &o) const
+    {
+      return pcmHash == o.pcmHash && configHash == o.configHash && pcmBytes == o.pcmBytes;
+    }
+  };
+  struct KeyHash
+  {
+    size_t operator()(const Key &k) const { return static_cast<size_t>(k.pcmHash ^ (k.configHash * 0x9e3779b97f4a7c15ULL)); }
+  };
+  struct Entry
+  {
+    Key key;
+    std::vector<unsigned char> data; // packets back to back
+    std::vector<uint32_t> ends;      // end offset of each packet in data
+    size_t Cost() const { return sizeof(Entry) + data.size() + ends.size() * sizeof(uint32_t); }
+  };
+
+  // JS‑exposed methods
+  Napi::Value Encode(const Napi::CallbackInfo &);
+  Napi::Value Stats(const Napi::CallbackInfo &);
+  Napi::Value Clear(const Napi::CallbackInfo &);
+
+  // Helpers
+  void Insert(Entry &&entry);
+  static Napi::Array ToArray(Napi::Env env, const Entry &entry);
+
+  // Members
+  size_t maxBytes_{64 * 1024 * 1024};
+  size_t bytes_{0};
+  std::list<Entry> lru_; // most recently used at the front
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  uint64_t evictions_{0};
+};
@@ -0,0 +1,404 @@
+// codec-pool.cc – EDF, work‑stealing thread pool for async encode/decode.
+
+#include "codec-pool.h"
+#include <algorithm>
+#include "byte-view.h"
+#include "node-opus.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// -----------------------------------------------------------------------------
+CodecPoolWrap::CodecPoolWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<CodecPoolWrap>(info)
+{
+  Napi::Env env = info.Env();
+  unsigned hw = std::thread::hardware_concurrency();
+  unsigned threads = hw > 1 ? hw / 2 : 1;
+  bool pin = false;
+  if (info.Length() > 0 && info[0].IsObject())
+  {
+    Napi::Object o = info[0].As<Napi::Object>();
+    if (o.Get("threads").IsNumber())
+      threads = o.Get("threads").ToNumber().Uint32Value();
+    pin = o.Get("pinThreads").ToBoolean().Value();
+  }
+  if (threads < 1 || threads > 256)
+  {
+    Napi::RangeError::New(env, "threads must be between 1 and 256").ThrowAsJavaScriptException();
+    return;
+  }
+
+  tsfn_ = Napi::ThreadSafeFunction::New(env, Napi::Function(), "CodecPool", 0, 1);
+  tsfn_.Unref(env); // only keep the loop alive while jobs are in flight
+
+  queues_ = std::vector<Queue>(threads);
+  for (unsigned i = 0; i < threads; ++i)
+  {
+    threads_.emplace_back(&CodecPoolWrap::Loop, this, i);
+#ifdef __linux__
+    if (pin && hw > 0)
+    {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(i % hw, &set);
+      pthread_setaffinity_np(threads_.back().native_handle(), sizeof(set), &set);
+    }
+#else
+    (void)pin; // affinity is best effort and Linux‑only
+#endif
+  }
+}
+
+CodecPoolWrap::~CodecPoolWrap()
+{
+  // Collected without close(): nothing is in flight (jobs Ref() the pool), so
+  // the threads are idle and join at once. After close() only the reaper can
+  // be left, if the environment went away before it reported back.
+  if (!closed_)
+  {
+    StopThreads();
+    for (std::thread &t : threads_)
+      t.join();
+    tsfn_.Release();
+  }
+  if (reaper_.joinable())
+    reaper_.join();
+}
+
+void CodecPoolWrap::StopThreads()
+{
+  closed_ = true;
+  {
+    std::lock_guard<std::mutex> lk(idleMu_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+// Queues
+// -----------------------------------------------------------------------------
+void CodecPoolWrap::Push(Job *job, size_t queue)
+{
+  Queue &q = queues_[queue];
+  {
+    std::lock_guard<std::mutex> lk(q.mu);
+    q.heap.push_back(job);
+    std::push_heap(q.heap.begin(), q.heap.end(), Later());
+  }
+  size_t depth = ++queued_;
+  size_t seen = maxQueued_.load(std::memory_order_relaxed);
+  while (depth > seen && !maxQueued_.compare_exchange_weak(seen, depth))
+  {
+  }
+  {
+    std::lock_guard<std::mutex> lk(idleMu_); // pairs with the wait in Loop()
+  }
+  wake_.notify_one();
+}
+
+CodecPoolWrap::Job *CodecPoolWrap::Pop(size_t self)
+{
+  {
+    Queue &q = queues_[self];
+    std::lock_guard<std::mutex> lk(q.mu);
+    if (!q.heap.empty())
+    {
+      std::pop_heap(q.heap.begin(), q.heap.end(), Later());
+      Job *job = q.heap.back();
+      q.heap.pop_back();
+      return job;
+    }
+  }
+
+  // Steal the most urgent job from any peer.
+  for (;;)
+  {
+    size_t victim = queues_.size();
+    Job *best = nullptr;
+    for (size_t i = 0; i < queues_.size(); ++i)
+    {
+      if (i == self)
+        continue;
+      std::lock_guard<std::mutex> lk(queues_[i].mu);
+      if (!queues_[i].heap.empty() && (!best || Later()(best, queues_[i].heap.front())))
+      {
+        best = queues_[i].heap.front();
+        victim = i;
+      }
+    }
+    if (!best)
+      return nullptr;
+
+    Queue &q = queues_[victim];
+    std::lock_guard<std::mutex> lk(q.mu);
+    if (q.heap.empty() || q.heap.front() != best)
+      continue; // raced with the owner; look again
+    std::pop_heap(q.heap.begin(), q.heap.end(), Later());
+    q.heap.pop_back();
+    ++stolen_;
+    return best;
+  }
+}
+
+void CodecPoolWrap::Loop(size_t self)
+{
+  for (;;)
+  {
+    Job *job = Pop(self);
+    if (job)
+    {
+      --queued_;
+      Run(job, self);
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(idleMu_);
+    wake_.wait(lk, [this] { return stop_ || queued_.load() > 0; });
+    if (stop_ && queued_.load() == 0)
+      return;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Job execution (pool thread) and completion (JS thread)
+// -----------------------------------------------------------------------------
+void CodecPoolWrap::Run(Job *job, size_t self)
+{
+  if (job->encode)
+  {
+    job->out.resize(MAX_PACKET_SIZE);
+    job->rc = job->codec->EncodeInto(reinterpret_cast<const opus_int16 *>(job->in), job->frameSize, job->out.data(),
+                                     MAX_PACKET_SIZE);
+    if (job->rc >= 0)
+      job->out.resize(job->rc);
+  }
+  else
+  {
+    const size_t frameBytes = static_cast<size_t>(job->codec->Channels()) * sizeof(opus_int16);
+    job->out.resize(MAX_FRAME_SIZE * frameBytes);
+    job->rc = job->codec->DecodeInto(job->in, static_cast<opus_int32>(job->inLen),
+                                     reinterpret_cast<opus_int16 *>(job->out.data()), MAX_FRAME_SIZE);
+    if (job->rc >= 0)
+      job->out.resize(job->rc * frameBytes);
+  }
+
+  ++completed_;
+  int64_t lateUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - job->due).count();
+  if (lateUs > 0)
+  {
+    ++missed_;
+    int64_t worst = worstLatenessUs_.load(std::memory_order_relaxed);
+    while (lateUs > worst && !worstLatenessUs_.compare_exchange_weak(worst, lateUs))
+    {
+    }
+  }
+
+  // Release the strand: the next job for this codec becomes runnable.
+  Job *next = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(strandMu_);
+    auto it = strands_.find(job->codec);
+    it->second.pop_front();
+    if (it->second.empty())
+      strands_.erase(it);
+    else
+      next = it->second.front();
+  }
+  if (next)
+    Push(next, self);
+
+  tsfn_.NonBlockingCall(job, [this](Napi::Env env, Napi::Function, Job *done) { Complete(env, done); });
+}
+
+void CodecPoolWrap::Complete(Napi::Env env, Job *job)
+{
+  if (--job->codec->asyncPending_ == 0)
+    job->codec->asyncOwner_ = nullptr;
+  if (job->rc < 0)
+    job->deferred.Reject(Napi::Error::New(env, StrError(job->rc)).Value());
+  else
+    job->deferred.Resolve(Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(job->out.data()), job->out.size()));
+  delete job;
+
+  if (--inFlight_ == 0)
+  {
+    if (!closed_)
+      tsfn_.Unref(env);
+    Unref(); // pool may be collected again
+  }
+}
+
+// -----------------------------------------------------------------------------
+// encode(encoder, pcm, dueMs?) / decode(encoder, packet, dueMs?) -> Promise<Buffer>
+// -----------------------------------------------------------------------------
+Napi::Value CodecPoolWrap::Submit(const Napi::CallbackInfo &info, bool encode)
+{
+  Napi::Env env = info.Env();
+  OpusEncoderWrap *codec = info.Length() > 0 ? OpusEncoderWrap::FromValue(env, info[0]) : nullptr;
+  ByteView buf;
+  if (!codec || info.Length() < 2 || !GetByteView(env, info[1], &buf) ||
+      (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNumber()))
+  {
+    Napi::TypeError::New(env, "Expected (encoder: OpusEncoder, data: Buffer | ArrayBufferView | ArrayBuffer, dueMs?: number)")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (closed_)
+  {
+    Napi::Error::New(env, "CodecPool is closed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (codec->asyncOwner_ ? codec->asyncOwner_ != this : codec->asyncPending_ != 0)
+  {
+    Napi::Error::New(env, "Encoder has pending async work on another CodecPool").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int frameSize = 0;
+  if (encode)
+  {
+    if (buf.length % (2 * codec->Channels()) != 0)
+    {
+      Napi::RangeError::New(env, "PCM buffer length must be multiple of (channels*2 bytes)").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    frameSize = static_cast<int>(buf.length / 2 / codec->Channels());
+    if (frameSize == 0)
+    {
+      Napi::RangeError::New(env, "PCM buffer is empty").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (frameSize > MAX_FRAME_SIZE)
+    {
+      Napi::RangeError::New(env, "Frame exceeds MAX_FRAME_SIZE").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  // Default deadline: one 20 ms frame from now.
+  double dueMs = info.Length() > 2 && info[2].IsNumber() ? info[2].ToNumber().DoubleValue() : 20.0;
+
+  Job *job = new Job(env);
+  job->encode = encode;
+  job->codec = codec;
+  job->due = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(dueMs * 1000.0));
+  job->seq = seq_++;
+  job->in = encode ? reinterpret_cast<const unsigned char *>(AlignedPcm(buf, &job->inCopy)) : buf.data;
+  job->inLen = buf.length;
+  job->frameSize = frameSize;
+  job->codecRef = Napi::Persistent(info[0].As<Napi::Object>());
+  job->inputRef = Napi::Persistent(info[1].As<Napi::Object>());
+  Napi::Promise promise = job->deferred.Promise();
+
+  codec->asyncPending_++;
+  codec->asyncOwner_ = this;
+  if (inFlight_++ == 0)
+  {
+    tsfn_.Ref(env);
+    Ref(); // completions call back into this object
+  }
+
+  bool runnable;
+  {
+    std::lock_guard<std::mutex> lk(strandMu_);
+    std::deque<Job *> &strand = strands_[codec];
+    strand.push_back(job);
+    runnable = strand.size() == 1;
+  }
+  if (runnable)
+    Push(job, next_++ % queues_.size());
+  return promise;
+}
+
+Napi::Value CodecPoolWrap::Encode(const Napi::CallbackInfo &info)
+{
+  return Submit(info, true);
+}
+
+Napi::Value CodecPoolWrap::Decode(const Napi::CallbackInfo &info)
+{
+  return Submit(info, false);
+}
+
+Napi::Value CodecPoolWrap::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  Napi::Array depths = Napi::Array::New(env, queues_.size());
+  for (uint32_t i = 0; i < queues_.size(); ++i)
+  {
+    std::lock_guard<std::mutex> lk(queues_[i].mu);
+    depths.Set(i, Napi::Number::New(env, static_cast<double>(queues_[i].heap.size())));
+  }
+  stats.Set("threads", Napi::Number::New(env, static_cast<double>(threads_.size())));
+  stats.Set("queued", Napi::Number::New(env, static_cast<double>(queued_.load())));
+  stats.Set("queueDepths", depths);
+  stats.Set("maxQueued", Napi::Number::New(env, static_cast<double>(maxQueued_.load())));
+  stats.Set("inFlight", Napi::Number::New(env, inFlight_));
+  stats.Set("completed", Napi::Number::New(env, static_cast<double>(completed_.load())));
+  stats.Set("missedDeadlines", Napi::Number::New(env, static_cast<double>(missed_.load())));
+  stats.Set("worstLatenessMs", Napi::Number::New(env, worstLatenessUs_.load() / 1000.0));
+  stats.Set("stolen", Napi::Number::New(env, static_cast<double>(stolen_.load())));
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+// close() -> Promise<void>
+// New jobs are refused at once; the threads finish what is queued and are
+// joined by a reaper thread, so the JS thread never waits for them.
+// -----------------------------------------------------------------------------
+Napi::Value CodecPoolWrap::Close(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (drained_)
+  {
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+  closeWaiters_.push_back(deferred);
+  if (closed_)
+    return deferred.Promise(); // already draining
+
+  StopThreads();
+  tsfn_.Ref(env);
+  Ref(); // the reaper reports back to this object
+  reaper_ = std::thread([this] {
+    for (std::thread &t : threads_)
+      t.join();
+    // Queued behind every job completion the threads posted.
+    tsfn_.NonBlockingCall(this, [](Napi::Env env, Napi::Function, CodecPoolWrap *pool) { pool->Drained(env); });
+  });
+  return deferred.Promise();
+}
+
+void CodecPoolWrap::Drained(Napi::Env env)
+{
+  reaper_.join();
+  threads_.clear();
+  drained_ = true;
+  tsfn_.Release();
+  for (Napi::Promise::Deferred &d : closeWaiters_)
+    d.Resolve(env.Undefined());
+  closeWaiters_.clear();
+  Unref();
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object CodecPoolWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<CodecPoolWrap>::DefineClass(env, "CodecPool", {
+                                                                                           InstanceMethod("encode", &CodecPoolWrap::Encode),
+                                                                                           InstanceMethod("decode", &CodecPoolWrap::Decode),
+                                                                                           InstanceMethod("stats", &CodecPoolWrap::Stats),
+                                                                                           InstanceMethod("close", &CodecPoolWrap::Close),
+                                                                                       });
+  exports.Set("CodecPool", ctor);
+  return exports;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "opus-common.h"
+
+class OpusEncoderWrap;
+
+// -----------------------------------------------------------------------------
+// CodecPool – dedicated real‑time threads for async encode/decode, separate
+// from the libuv pool (UV_THREADPOOL_SIZE) so fs/DNS work cannot delay frames.
+//
+// Each thread owns an earliest‑deadline‑first heap; idle threads steal the
+// most urgent job from their peers. Jobs for the same OpusEncoder run one at
+// a time in submission order (a "strand"), whatever their deadlines. An
+// encoder belongs to one pool while it has jobs there (see asyncOwner_).
+// -----------------------------------------------------------------------------
+class CodecPoolWrap : public Napi::ObjectWrap<CodecPoolWrap>
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  CodecPoolWrap(const Napi::CallbackInfo &);
+  ~CodecPoolWrap();
+
+private:
+  struct Job
+  {
+    bool encode{true};
+    OpusEncoderWrap *codec{nullptr};
+    Clock::time_point due;
+    uint64_t seq{0};
+    const unsigned char *in{nullptr};
+    size_t inLen{0};
+    std::vector<opus_int16> inCopy; // aligned PCM when the view was not
+    int frameSize{0}; // encode: samples per channel
+    std::vector<unsigned char> out;
+    int rc{0};
+    Napi::ObjectReference codecRef; // keep encoder + input alive until done
+    Napi::ObjectReference inputRef;
+    Napi::Promise::Deferred deferred;
+
+    explicit Job(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+  };
+
+  struct Later
+  {
+    bool operator()(const Job *a, const Job *b) const
+    {
+      return a->due != b->due ? a->due > b->due : a->seq > b->seq;
+    }
+  };
+
+  struct Queue
+  {
+    std::mutex mu;
+    std::vector<Job *> heap; // min‑heap on (due, seq)
+  };
+
+  // JS‑exposed methods
+  Napi::Value Encode(const Napi::CallbackInfo &);
+  Napi::Value Decode(const Napi::CallbackInfo &);
+  Napi::Value Stats(const Napi::CallbackInfo &);
+  Napi::Value Close(const Napi::CallbackInfo &);
+
+  // Helpers
+  Napi::Value Submit(const Napi::CallbackInfo &info, bool encode);
+  void Push(Job *job, size_t queue);
+  Job *Pop(size_t self);
+  void Loop(size_t self);
+  void Run(Job *job, size_t self);
+  void Complete(Napi::Env env, Job *job);
+  void Drained(Napi::Env env);
+  void StopThreads();
+
+  std::vector<std::thread> threads_;
+  std::vector<Queue> queues_;
+  std::mutex idleMu_;
+  std::condition_variable wake_;
+  std::atomic<size_t> queued_{0};
+  bool stop_{false};
+
+  std::mutex strandMu_;
+  std::unordered_map<OpusEncoderWrap *, std::deque<Job *>> strands_;
+
+  Napi::ThreadSafeFunction tsfn_;
+  bool closed_{false};  // no new jobs; threads finishing what is queued
+  bool drained_{false}; // threads joined, close() promises settled
+  std::thread reaper_;  // joins the threads after close()
+  std::vector<Napi::Promise::Deferred> closeWaiters_;
+  size_t next_{0};      // round‑robin submit target (JS thread only)
+  uint64_t seq_{0};     // FIFO tie‑break for equal deadlines (JS thread only)
+  uint32_t inFlight_{0}; // submitted, not yet settled (JS thread only)
+
+  // Stats
+  std::atomic<uint64_t> completed_{0};
+  std::atomic<uint64_t> missed_{0};
+  std::atomic<uint64_t> stolen_{0};
+  std::atomic<size_t> maxQueued_{0};
+  std::atomic<int64_t> worstLatenessUs_{0};
+};
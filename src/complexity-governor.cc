@@ -0,0 +1,86 @@
+// complexity-governor.cc – encode time budget controller.
+
+#include "complexity-governor.h"
+#include <algorithm>
+#include "opus-common.h"
+
+// Headroom below which the governor steps back up (fraction of the budget).
+static constexpr double kRaiseBelow = 0.6;
+
+void ComplexityGovernor::Configure(const Config &config)
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  config_ = config;
+  window_.clear();
+  window_.reserve(config.windowFrames);
+  lastP99_ = 0;
+  // Start from the top and let the first windows find the level.
+  complexity_.store(config.maxComplexity, std::memory_order_relaxed);
+  bandwidth_.store(OPUS_BANDWIDTH_FULLBAND, std::memory_order_relaxed);
+  adaptBandwidth_.store(config.adaptBandwidth, std::memory_order_relaxed);
+  enabled_.store(config.budgetUs > 0, std::memory_order_relaxed);
+}
+
+ComplexityGovernor &ComplexityGovernor::Global()
+{
+  static ComplexityGovernor governor;
+  return governor;
+}
+
+void ComplexityGovernor::Record(double us)
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  if (config_.budgetUs <= 0)
+    return;
+  ++frames_;
+  window_.push_back(static_cast<float>(us));
+  if (window_.size() >= static_cast<size_t>(config_.windowFrames))
+    Decide();
+}
+
+// Called with mu_ held and a full window.
+void ComplexityGovernor::Decide()
+{
+  size_t k = window_.size() - 1 - window_.size() / 100;
+  std::nth_element(window_.begin(), window_.begin() + k, window_.end());
+  double p99 = window_[k];
+  window_.clear();
+  lastP99_ = p99;
+
+  int c = complexity_.load(std::memory_order_relaxed);
+  int bw = bandwidth_.load(std::memory_order_relaxed);
+  if (p99 > config_.budgetUs)
+  {
+    // Far over budget: take two steps at once so a spike is absorbed quickly.
+    int step = p99 > 1.5 * config_.budgetUs ? 2 : 1;
+    if (c > config_.minComplexity)
+      c = std::max(config_.minComplexity, c - step);
+    else if (config_.adaptBandwidth && bw > OPUS_BANDWIDTH_WIDEBAND)
+      --bw;
+    else
+      return;
+  }
+  else if (p99 < kRaiseBelow * config_.budgetUs)
+  {
+    // Undo in reverse order: bandwidth first, then complexity.
+    if (bw < OPUS_BANDWIDTH_FULLBAND)
+      ++bw;
+    else if (c < config_.maxComplexity)
+      ++c;
+    else
+      return;
+  }
+  else
+  {
+    return;
+  }
+  complexity_.store(c, std::memory_order_relaxed);
+  bandwidth_.store(bw, std::memory_order_relaxed);
+  ++adjustments_;
+}
+
+ComplexityGovernor::Stats ComplexityGovernor::GetStats()
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  return {Complexity(), MaxBandwidth(), lastP99_, frames_, adjustments_};
+}
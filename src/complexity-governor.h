@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// ComplexityGovernor – keeps p99 opus_encode wall time under a budget.
+// Encoders report the duration of every real encode; once per window the p99
+// is compared with the budget and the target complexity (then, optionally,
+// the maximum bandwidth) is stepped down, or back up when there is headroom.
+// One governor can be private to an encoder or shared by all of them
+// (Global()); Record() is thread‑safe and the targets are read lock‑free.
+// -----------------------------------------------------------------------------
+class ComplexityGovernor
+{
+public:
+  struct Config
+  {
+    double budgetUs{0};      // p99 target per frame; 0 disables
+    int minComplexity{0};
+    int maxComplexity{10};
+    int windowFrames{100};   // frames per decision
+    bool adaptBandwidth{false};
+  };
+
+  struct Stats
+  {
+    int complexity;
+    int maxBandwidth;
+    double p99Us;
+    uint64_t frames;
+    uint64_t adjustments;
+  };
+
+  void Configure(const Config &config);
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Reports one encode. Thread‑safe.
+  void Record(double us);
+
+  // Current targets (OPUS_SET_COMPLEXITY / OPUS_SET_MAX_BANDWIDTH values).
+  int Complexity() const { return complexity_.load(std::memory_order_relaxed); }
+  int MaxBandwidth() const { return bandwidth_.load(std::memory_order_relaxed); }
+  // MaxBandwidth() is only a target when the config asks for it.
+  bool AdaptsBandwidth() const { return adaptBandwidth_.load(std::memory_order_relaxed); }
+
+  Stats GetStats();
+
+  // Process‑wide governor shared by encoders that opt in.
+  static ComplexityGovernor &Global();
+
+private:
+  void Decide();
+
+  std::mutex mu_;
+  Config config_;
+  std::vector<float> window_;
+  double lastP99_{0};
+  uint64_t frames_{0};
+  uint64_t adjustments_{0};
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> adaptBandwidth_{false};
+  std::atomic<int> complexity_{10};
+  std::atomic<int> bandwidth_{0}; // OPUS_BANDWIDTH_*; FULLBAND when unrestricted
+};
@@ -0,0 +1,230 @@
+// custom-encoder.cc – Opus custom mode (low‑delay CELT) encoder/decoder.
+
+#include "custom-encoder.h"
+#include "byte-view.h"
+
+// Custom modes accept frames from 40 to 1024 samples, even, >= 1 ms.
+static constexpr int kMinCustomFrame = 40;
+static constexpr int kMaxCustomFrame = 1024;
+
+// MDCT overlap of a custom mode; mirrors the LM choice in celt/modes.c.
+static int CustomOverlap(opus_int32 rate, int frameSize)
+{
+  int lm = 0;
+  if (static_cast<int64_t>(frameSize) * 75 >= rate && frameSize % 16 == 0)
+    lm = 3;
+  else if (static_cast<int64_t>(frameSize) * 150 >= rate && frameSize % 8 == 0)
+    lm = 2;
+  else if (static_cast<int64_t>(frameSize) * 300 >= rate && frameSize % 4 == 0)
+    lm = 1;
+  return ((frameSize >> lm) >> 2) << 2;
+}
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// new OpusCustomEncoder(rate, channels, frameSize, { bitrate = 64 kb/s per
+//                       channel, complexity })
+// -----------------------------------------------------------------------------
+OpusCustomEncoderWrap::OpusCustomEncoderWrap(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<OpusCustomEncoderWrap>(info)
+{
+  Napi::Env env = info.Env();
+#ifdef CUSTOM_MODES
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (rate: number, channels: number, frameSize: number, options?: object)")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  rate_ = info[0].ToNumber().Int32Value();
+  channels_ = info[1].ToNumber().Int32Value();
+  frameSize_ = info[2].ToNumber().Int32Value();
+  opus_int32 bitrate = 64000 * channels_;
+  int complexity = -1;
+  if (info.Length() > 3 && info[3].IsObject())
+  {
+    Napi::Object o = info[3].As<Napi::Object>();
+    if (o.Get("bitrate").IsNumber())
+      bitrate = o.Get("bitrate").ToNumber().Int32Value();
+    if (o.Get("complexity").IsNumber())
+      complexity = o.Get("complexity").ToNumber().Int32Value();
+  }
+  if (channels_ < 1 || channels_ > 2 || frameSize_ < kMinCustomFrame || frameSize_ > kMaxCustomFrame || frameSize_ % 2)
+  {
+    Napi::RangeError::New(env, "channels must be 1 or 2 and frameSize an even number from 40 to 1024").ThrowAsJavaScriptException();
+    return;
+  }
+
+  int err;
+  mode_ = opus_custom_mode_create(rate_, frameSize_, &err);
+  if (err == OPUS_OK)
+    enc_ = opus_custom_encoder_create(mode_, channels_, &err);
+  if (err == OPUS_OK)
+    dec_ = opus_custom_decoder_create(mode_, channels_, &err);
+  if (err != OPUS_OK)
+  {
+    Napi::RangeError::New(env, std::string("Unsupported custom mode: ") + StrError(err)).ThrowAsJavaScriptException();
+    return;
+  }
+  opus_custom_encoder_ctl(enc_, OPUS_SET_BITRATE(bitrate));
+  if (complexity >= 0)
+    opus_custom_encoder_ctl(enc_, OPUS_SET_COMPLEXITY(complexity));
+
+  overlap_ = CustomOverlap(rate_, frameSize_);
+  outPcm_.resize(static_cast<size_t>(channels_) * frameSize_);
+  outOpus_.resize(MAX_PACKET_SIZE);
+#else
+  Napi::Error::New(env, "OpusCustomEncoder needs a build with opus_custom_modes=1").ThrowAsJavaScriptException();
+#endif
+}
+
+OpusCustomEncoderWrap::~OpusCustomEncoderWrap()
+{
+#ifdef CUSTOM_MODES
+  if (enc_)
+    opus_custom_encoder_destroy(enc_);
+  if (dec_)
+    opus_custom_decoder_destroy(dec_);
+  if (mode_)
+    opus_custom_mode_destroy(mode_);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// encode(pcm) -> Buffer / decode(packet | null) -> Buffer
+// PCM is always exactly frameSize samples per channel; null decodes PLC.
+// -----------------------------------------------------------------------------
+Napi::Value OpusCustomEncoderWrap::Encode(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+#ifdef CUSTOM_MODES
+  ByteView view;
+  if (info.Length() < 1 || !GetByteView(env, info[0], &view))
+  {
+    Napi::TypeError::New(env, "Expected (pcm: Buffer | ArrayBufferView | ArrayBuffer)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (view.length != static_cast<size_t>(frameSize_) * channels_ * sizeof(opus_int16))
+  {
+    Napi::RangeError::New(env, "PCM must hold exactly frameSize samples per channel").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int len = opus_custom_encode(enc_, AlignedPcm(view, &inPcm_), frameSize_, outOpus_.data(), MAX_PACKET_SIZE);
+  if (len < 0)
+  {
+    Napi::Error::New(env, StrError(len)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(outOpus_.data()), len);
+#else
+  return env.Null();
+#endif
+}
+
+Napi::Value OpusCustomEncoderWrap::Decode(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+#ifdef CUSTOM_MODES
+  ByteView view;
+  bool plc = info.Length() > 0 && (info[0].IsNull() || info[0].IsUndefined());
+  if (info.Length() < 1 || (!plc && !GetByteView(env, info[0], &view)))
+  {
+    Napi::TypeError::New(env, "Expected (packet: Buffer | ArrayBufferView | ArrayBuffer | null)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int n = opus_custom_decode(dec_, plc ? nullptr : view.data, plc ? 0 : static_cast<int>(view.length), outPcm_.data(),
+                             frameSize_);
+  if (n < 0)
+  {
+    Napi::Error::New(env, StrError(n)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(outPcm_.data()),
+                                  static_cast<size_t>(n) * channels_ * sizeof(opus_int16));
+#else
+  return env.Null();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Controls
+// -----------------------------------------------------------------------------
+Napi::Value OpusCustomEncoderWrap::SetBitrate(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+#ifdef CUSTOM_MODES
+  if (info.Length() < 1 || !info[0].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (bitrate: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int rc = opus_custom_encoder_ctl(enc_, OPUS_SET_BITRATE(info[0].ToNumber().Int32Value()));
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+#endif
+  return env.Undefined();
+}
+
+// applyEncoderCTL(ctl, value) – integer setters understood by the CELT encoder
+Napi::Value OpusCustomEncoderWrap::ApplyEncoderCTL(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+#ifdef CUSTOM_MODES
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (ctl: number, value: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int rc = opus_custom_encoder_ctl(enc_, info[0].ToNumber().Int32Value(), info[1].ToNumber().Int32Value());
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+#endif
+  return env.Undefined();
+}
+
+Napi::Value OpusCustomEncoderWrap::GetFrameSize(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), frameSize_);
+}
+
+// Algorithmic delay: one frame of buffering plus the MDCT overlap.
+Napi::Value OpusCustomEncoderWrap::GetDelay(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), frameSize_ + overlap_);
+}
+
+Napi::Value OpusCustomEncoderWrap::GetDelayMs(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), rate_ ? (frameSize_ + overlap_) * 1000.0 / rate_ : 0.0);
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object OpusCustomEncoderWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<OpusCustomEncoderWrap>::DefineClass(env, "OpusCustomEncoder", {
+                                                                                                         InstanceMethod("encode", &OpusCustomEncoderWrap::Encode),
+                                                                                                         InstanceMethod("decode", &OpusCustomEncoderWrap::Decode),
+                                                                                                         InstanceMethod("setBitrate", &OpusCustomEncoderWrap::SetBitrate),
+                                                                                                         InstanceMethod("applyEncoderCTL", &OpusCustomEncoderWrap::ApplyEncoderCTL),
+                                                                                                         InstanceAccessor("frameSize", &OpusCustomEncoderWrap::GetFrameSize, nullptr),
+                                                                                                         InstanceAccessor("delay", &OpusCustomEncoderWrap::GetDelay, nullptr),
+                                                                                                         InstanceAccessor("delayMs", &OpusCustomEncoderWrap::GetDelayMs, nullptr),
+                                                                                                     });
+  exports.Set("OpusCustomEncoder", ctor);
+  exports.Set("customModes", Napi::Boolean::New(env,
+#ifdef CUSTOM_MODES
+                                                 true
+#else
+                                                 false
+#endif
+                                                 ));
+  return exports;
+}
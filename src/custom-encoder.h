@@ -0,0 +1,46 @@
+#pragma once
+
+#include <napi.h>
+#include <vector>
+#include "opus-common.h"
+#include "../libopus/opus/include/opus_custom.h"
+
+// -----------------------------------------------------------------------------
+// OpusCustomEncoder – CELT‑only Opus custom mode (opus_custom_*) with any even
+// frame size from 40 to 1024 samples, for links that need less delay than the
+// 2.5 ms + lookahead floor of standard Opus. Packets carry no TOC and only
+// decode with the same rate, channels and frame size.
+// The methods exist only in builds with opus_custom_modes=1 (CUSTOM_MODES);
+// otherwise the constructor throws.
+// -----------------------------------------------------------------------------
+class OpusCustomEncoderWrap : public Napi::ObjectWrap<OpusCustomEncoderWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  OpusCustomEncoderWrap(const Napi::CallbackInfo &);
+  ~OpusCustomEncoderWrap();
+
+private:
+  // JS‑exposed methods
+  Napi::Value Encode(const Napi::CallbackInfo &);
+  Napi::Value Decode(const Napi::CallbackInfo &);
+  Napi::Value SetBitrate(const Napi::CallbackInfo &);
+  Napi::Value ApplyEncoderCTL(const Napi::CallbackInfo &);
+  Napi::Value GetFrameSize(const Napi::CallbackInfo &);
+  Napi::Value GetDelay(const Napi::CallbackInfo &);
+  Napi::Value GetDelayMs(const Napi::CallbackInfo &);
+
+  // Members
+  opus_int32 rate_{48000};
+  int channels_{0};
+  int frameSize_{0};
+  int overlap_{0}; // MDCT overlap of the mode, in samples
+
+  OpusCustomMode *mode_{nullptr};
+  OpusCustomEncoder *enc_{nullptr};
+  OpusCustomDecoder *dec_{nullptr};
+
+  std::vector<opus_int16> inPcm_;  // aligned copy of odd‑offset input views
+  std::vector<opus_int16> outPcm_; // channels_ * frameSize_
+  std::vector<unsigned char> outOpus_;
+};
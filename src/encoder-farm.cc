@@ -0,0 +1,275 @@
+// encoder-farm.cc – flat, id‑addressed table of libopus encoders.
+
+#include "encoder-farm.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <string>
+#include "worker-pool.h"
+
+static constexpr uint32_t kTickBlock = 64;      // streams per pool task
+static constexpr int64_t kMaxCapacity = 1 << 18; // ~10 GB of stereo states
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// -----------------------------------------------------------------------------
+EncoderFarmWrap::EncoderFarmWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<EncoderFarmWrap>(info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (rate: number, channels: number, capacity: number, options?: object)").ThrowAsJavaScriptException();
+    return;
+  }
+
+  rate_ = info[0].ToNumber().Int32Value();
+  channels_ = info[1].ToNumber().Int32Value();
+  int64_t capacity = info[2].ToNumber().Int64Value();
+  frameSize_ = rate_ / 50;
+
+  if (info.Length() > 3 && info[3].IsObject())
+  {
+    Napi::Object o = info[3].As<Napi::Object>();
+    if (o.Get("frameSize").IsNumber())
+      frameSize_ = o.Get("frameSize").ToNumber().Int32Value();
+    if (o.Get("application").IsNumber())
+      application_ = o.Get("application").ToNumber().Int32Value();
+  }
+
+  int size = opus_encoder_get_size(channels_);
+  if (size <= 0 || rate_ <= 0 || capacity <= 0 || capacity > kMaxCapacity || frameSize_ <= 0 || frameSize_ > MAX_FRAME_SIZE)
+  {
+    Napi::RangeError::New(env, "Invalid channels, capacity or frameSize").ThrowAsJavaScriptException();
+    return;
+  }
+
+  const size_t align = alignof(std::max_align_t);
+  const size_t stride = (static_cast<size_t>(size) + align - 1) / align * align;
+  states_ = reinterpret_cast<unsigned char *>(new (std::nothrow) std::max_align_t[capacity * stride / align]);
+  if (!states_)
+  {
+    Napi::RangeError::New(env, "Not enough memory for " + std::to_string(capacity) + " encoder states")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  capacity_ = static_cast<uint32_t>(capacity);
+  stateStride_ = stride;
+  active_.assign(capacity_, 0);
+  // Lets V8 weigh the farm by its real size when scheduling GC.
+  Napi::MemoryManagement::AdjustExternalMemory(env, static_cast<int64_t>(capacity_ * stateStride_));
+}
+
+EncoderFarmWrap::~EncoderFarmWrap()
+{
+  // States are plain memory inside our block; nothing to destroy per stream.
+  if (!states_)
+    return;
+  delete[] reinterpret_cast<std::max_align_t *>(states_);
+  Napi::MemoryManagement::AdjustExternalMemory(Env(), -static_cast<int64_t>(capacity_ * stateStride_));
+}
+
+bool EncoderFarmWrap::CheckId(Napi::Env env, const Napi::Value &v, uint32_t *id) const
+{
+  if (!v.IsNumber())
+  {
+    Napi::TypeError::New(env, "Stream id must be a number").ThrowAsJavaScriptException();
+    return false;
+  }
+  int64_t i = v.ToNumber().Int64Value();
+  if (i < 0 || i >= static_cast<int64_t>(capacity_) || !active_[i])
+  {
+    Napi::RangeError::New(env, "Unknown stream id").ThrowAsJavaScriptException();
+    return false;
+  }
+  *id = static_cast<uint32_t>(i);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Stream lifecycle
+// -----------------------------------------------------------------------------
+Napi::Value EncoderFarmWrap::Add(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  uint32_t id;
+  if (!free_.empty())
+  {
+    id = free_.back();
+    free_.pop_back();
+  }
+  else if (highWater_ < capacity_)
+  {
+    id = highWater_++;
+  }
+  else
+  {
+    Napi::RangeError::New(env, "EncoderFarm is full").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int rc = opus_encoder_init(At(id), rate_, channels_, application_);
+  if (rc == OPUS_OK && info.Length() > 0 && info[0].IsNumber())
+    rc = opus_encoder_ctl(At(id), OPUS_SET_BITRATE(info[0].ToNumber().Int32Value()));
+  if (rc != OPUS_OK)
+  {
+    free_.push_back(id);
+    Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  active_[id] = 1;
+  return Napi::Number::New(env, id);
+}
+
+Napi::Value EncoderFarmWrap::Remove(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  uint32_t id;
+  if (info.Length() < 1 || !CheckId(env, info[0], &id))
+    return env.Null();
+  active_[id] = 0;
+  free_.push_back(id);
+  return env.Undefined();
+}
+
+// -----------------------------------------------------------------------------
+// Per‑stream CTLs
+// -----------------------------------------------------------------------------
+Napi::Value EncoderFarmWrap::SetBitrate(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  uint32_t id;
+  if (info.Length() < 2 || !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (id: number, bitrate: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!CheckId(env, info[0], &id))
+    return env.Null();
+
+  int rc = opus_encoder_ctl(At(id), OPUS_SET_BITRATE(info[1].ToNumber().Int32Value()));
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Number::New(env, rc);
+}
+
+Napi::Value EncoderFarmWrap::ApplyEncoderCTL(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  uint32_t id;
+  if (info.Length() < 3 || !info[1].IsNumber() || !info[2].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (id: number, ctl: number, value: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!CheckId(env, info[0], &id))
+    return env.Null();
+
+  int rc = opus_encoder_ctl(At(id), info[1].ToNumber().Int32Value(), info[2].ToNumber().Int32Value());
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Number::New(env, rc);
+}
+
+// -----------------------------------------------------------------------------
+// tickAll(pcmSlab, outSlab, lengths, parallel?) -> packets encoded
+// Slot i of each slab belongs to stream id i. lengths[i] receives the packet
+// length, 0 for an inactive id, or a negative libopus error for that stream.
+// -----------------------------------------------------------------------------
+Napi::Value EncoderFarmWrap::TickAll(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsBuffer() || !info[2].IsTypedArray() ||
+      info[2].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array)
+  {
+    Napi::TypeError::New(env, "Expected (pcmSlab: Buffer, outSlab: Buffer, lengths: Int32Array, parallel?: boolean)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Buffer<char> pcmSlab = info[0].As<Napi::Buffer<char>>();
+  Napi::Buffer<unsigned char> outSlab = info[1].As<Napi::Buffer<unsigned char>>();
+  Napi::Int32Array lengths = info[2].As<Napi::Int32Array>();
+  const size_t pcmStride = static_cast<size_t>(frameSize_) * channels_;
+  if (pcmSlab.Length() < highWater_ * pcmStride * sizeof(opus_int16) ||
+      outSlab.Length() < static_cast<size_t>(highWater_) * MAX_PACKET_SIZE || lengths.ElementLength() < highWater_)
+  {
+    Napi::RangeError::New(env, "Slabs must hold one slot per stream id").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  bool parallel = info.Length() < 4 || info[3].ToBoolean().Value();
+
+  const opus_int16 *pcm = reinterpret_cast<const opus_int16 *>(pcmSlab.Data());
+  unsigned char *out = outSlab.Data();
+  int32_t *lens = lengths.Data();
+  std::vector<uint32_t> counts((highWater_ + kTickBlock - 1) / kTickBlock, 0);
+
+  auto block = [&](size_t b) {
+    uint32_t end = std::min<uint32_t>(highWater_, static_cast<uint32_t>((b + 1) * kTickBlock));
+    for (uint32_t id = static_cast<uint32_t>(b * kTickBlock); id < end; ++id)
+    {
+      if (!active_[id])
+      {
+        lens[id] = 0;
+        continue;
+      }
+      lens[id] = opus_encode(At(id), pcm + id * pcmStride, frameSize_, out + static_cast<size_t>(id) * MAX_PACKET_SIZE,
+                             MAX_PACKET_SIZE);
+      if (lens[id] > 0)
+        ++counts[b];
+    }
+  };
+
+  if (parallel)
+    WorkerPool::Shared().Run(counts.size(), block);
+  else
+    for (size_t b = 0; b < counts.size(); ++b)
+      block(b);
+
+  uint32_t total = 0;
+  for (uint32_t c : counts)
+    total += c;
+  return Napi::Number::New(env, total);
+}
+
+// -----------------------------------------------------------------------------
+// Layout accessors
+// -----------------------------------------------------------------------------
+Napi::Value EncoderFarmWrap::GetPcmStride(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), static_cast<double>(frameSize_) * channels_ * sizeof(opus_int16));
+}
+
+Napi::Value EncoderFarmWrap::GetOutStride(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), MAX_PACKET_SIZE);
+}
+
+Napi::Value EncoderFarmWrap::GetActiveCount(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), highWater_ - free_.size());
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object EncoderFarmWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<EncoderFarmWrap>::DefineClass(env, "EncoderFarm", {
+                                                                                               InstanceMethod("add", &EncoderFarmWrap::Add),
+                                                                                               InstanceMethod("remove", &EncoderFarmWrap::Remove),
+                                                                                               InstanceMethod("setBitrate", &EncoderFarmWrap::SetBitrate),
+                                                                                               InstanceMethod("applyEncoderCTL", &EncoderFarmWrap::ApplyEncoderCTL),
+                                                                                               InstanceMethod("tickAll", &EncoderFarmWrap::TickAll),
+                                                                                               InstanceAccessor("pcmStride", &EncoderFarmWrap::GetPcmStride, nullptr),
+                                                                                               InstanceAccessor("outStride", &EncoderFarmWrap::GetOutStride, nullptr),
+                                                                                               InstanceAccessor("activeCount", &EncoderFarmWrap::GetActiveCount, nullptr),
+                                                                                           });
+  exports.Set("EncoderFarm", ctor);
+  return exports;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// EncoderFarm – many encoder streams behind one JS object.
+// Encoder states live back to back in one allocation and are addressed by an
+// integer id; tickAll() encodes every active stream from a shared PCM slab into
+// a shared output slab in a single N‑API call.
+// -----------------------------------------------------------------------------
+class EncoderFarmWrap : public Napi::ObjectWrap<EncoderFarmWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  EncoderFarmWrap(const Napi::CallbackInfo &);
+  ~EncoderFarmWrap();
+
+private:
+  // JS‑exposed methods
+  Napi::Value Add(const Napi::CallbackInfo &);
+  Napi::Value Remove(const Napi::CallbackInfo &);
+  Napi::Value SetBitrate(const Napi::CallbackInfo &);
+  Napi::Value ApplyEncoderCTL(const Napi::CallbackInfo &);
+  Napi::Value TickAll(const Napi::CallbackInfo &);
+  Napi::Value GetPcmStride(const Napi::CallbackInfo &);
+  Napi::Value GetOutStride(const Napi::CallbackInfo &);
+  Napi::Value GetActiveCount(const Napi::CallbackInfo &);
+
+  // Helpers
+  OpusEncoder *At(uint32_t id) const { return reinterpret_cast<OpusEncoder *>(states_ + id * stateStride_); }
+  bool CheckId(Napi::Env env, const Napi::Value &v, uint32_t *id) const;
+
+  // Members
+  opus_int32 rate_{0};
+  int channels_{0};
+  int frameSize_{0}; // samples per channel per tick
+  int application_{OPUS_APPLICATION_AUDIO};
+  uint32_t capacity_{0};
+  uint32_t highWater_{0}; // ids >= highWater_ have never been used
+
+  unsigned char *states_{nullptr}; // capacity_ * stateStride_
+  size_t stateStride_{0};
+  std::vector<uint8_t> active_;
+  std::vector<uint32_t> free_; // recycled ids, reused LIFO
+};
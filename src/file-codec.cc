@@ -0,0 +1,500 @@
+// file-codec.cc – parallel whole‑file encode into / decode from Ogg Opus.
+
+#include "file-codec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ogg-opus.h"
+#include "opus-common.h"
+#include "worker-pool.h"
+
+// Defaults for segmenting; both can be overridden from JS.
+static constexpr double kDefaultSegmentSeconds = 10.0;
+static constexpr double kDefaultPreRollMs = 200.0;
+static constexpr double kDefaultDecodePreRollMs = 80.0; // RFC 7845 §4.6
+
+// Threads for a private pool: a long file job must not hold up the shared
+// pool that real‑time callers (LadderEncoder) run on.
+static unsigned FileJobThreads(size_t segments)
+{
+  unsigned hw = std::thread::hardware_concurrency();
+  return static_cast<unsigned>(std::min<size_t>(segments, hw > 1 ? hw : 1) - 1);
+}
+
+// -----------------------------------------------------------------------------
+// Options shared by the parallel encoders
+// -----------------------------------------------------------------------------
+struct EncodeFileOptions
+{
+  opus_int32 rate{48000};
+  int channels{2};
+  int application{OPUS_APPLICATION_AUDIO};
+  opus_int32 bitrate{OPUS_AUTO};
+  int complexity{-1}; // -1 = libopus default
+  int frameSize{0};   // samples per channel, 0 = 20 ms
+  double segmentSeconds{kDefaultSegmentSeconds};
+  double preRollMs{kDefaultPreRollMs};
+  uint32_t serial{0x4f707573}; // "Opus"
+};
+
+// -----------------------------------------------------------------------------
+// AsyncWorker: segment encode on the WorkerPool, then Ogg splice
+// -----------------------------------------------------------------------------
+class EncodeFileWorker : public Napi::AsyncWorker
+{
+public:
+  EncodeFileWorker(Napi::Env env, Napi::Buffer<char> pcm, const EncodeFileOptions &opts)
+      : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)), opts_(opts),
+        pcm_(reinterpret_cast<const opus_int16 *>(pcm.Data())),
+        samples_(pcm.Length() / 2 / opts.channels)
+  {
+    pcmRef_ = Napi::Persistent(pcm.As<Napi::Object>());
+  }
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+  struct Segment
+  {
+    size_t firstFrame{0};
+    size_t frames{0};
+    std::vector<unsigned char> bytes;
+    std::vector<int> lens;
+    int err{OPUS_OK};
+  };
+
+  void Execute() override
+  {
+    const int F = opts_.frameSize;
+    const int channels = opts_.channels;
+
+    // Encoder lookahead decides pre‑skip and how many frames flush the tail.
+    int err;
+    OpusEncoder *probe = opus_encoder_create(opts_.rate, channels, opts_.application, &err);
+    if (err != OPUS_OK)
+    {
+      SetError(StrError(err));
+      return;
+    }
+    opus_int32 lookahead = 0;
+    opus_encoder_ctl(probe, OPUS_GET_LOOKAHEAD(&lookahead));
+    opus_encoder_destroy(probe);
+
+    const size_t frames = (samples_ + lookahead + F - 1) / F;
+    const size_t segFrames = std::max<size_t>(1, static_cast<size_t>(opts_.segmentSeconds * opts_.rate / F));
+    const size_t preRoll = static_cast<size_t>((opts_.preRollMs * opts_.rate / 1000.0 + F - 1) / F);
+
+    std::vector<Segment> segments((frames + segFrames - 1) / segFrames);
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+      segments[s].firstFrame = s * segFrames;
+      segments[s].frames = std::min(segFrames, frames - segments[s].firstFrame);
+    }
+
+    WorkerPool pool(FileJobThreads(segments.size()));
+    pool.Run(segments.size(), [&](size_t s) {
+      Segment &seg = segments[s];
+      int e;
+      OpusEncoder *enc = opus_encoder_create(opts_.rate, channels, opts_.application, &e);
+      if (e != OPUS_OK)
+      {
+        seg.err = e;
+        return;
+      }
+      if (opts_.bitrate != OPUS_AUTO)
+        opus_encoder_ctl(enc, OPUS_SET_BITRATE(opts_.bitrate));
+      if (opts_.complexity >= 0)
+        opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY(opts_.complexity));
+
+      std::vector<opus_int16> frame(static_cast<size_t>(F) * channels);
+      unsigned char packet[MAX_PACKET_SIZE];
+      seg.bytes.reserve(seg.frames * 160);
+      seg.lens.reserve(seg.frames);
+
+      // Start early so the encoder state has converged at the boundary; the
+      // pre‑roll packets are encoded and dropped.
+      size_t start = seg.firstFrame > preRoll ? seg.firstFrame - preRoll : 0;
+      for (size_t k = start; k < seg.firstFrame + seg.frames; ++k)
+      {
+        size_t from = k * F;
+        size_t avail = from < samples_ ? std::min<size_t>(F, samples_ - from) : 0;
+        std::memcpy(frame.data(), pcm_ + from * channels, avail * channels * sizeof(opus_int16));
+        std::fill(frame.begin() + avail * channels, frame.end(), 0);
+
+        int len = opus_encode(enc, frame.data(), F, packet, MAX_PACKET_SIZE);
+        if (len < 0)
+        {
+          seg.err = len;
+          break;
+        }
+        if (k >= seg.firstFrame)
+        {
+          seg.bytes.insert(seg.bytes.end(), packet, packet + len);
+          seg.lens.push_back(len);
+        }
+      }
+      opus_encoder_destroy(enc);
+    });
+
+    for (const Segment &seg : segments)
+    {
+      if (seg.err != OPUS_OK)
+      {
+        SetError(StrError(seg.err));
+        return;
+      }
+    }
+
+    // Splice: granules count 48 kHz samples including pre‑skip; the last page
+    // carries pre‑skip + input length so players trim the padding.
+    const int64_t scale = 48000 / opts_.rate;
+    const int64_t preSkip = static_cast<int64_t>(lookahead) * scale;
+    const int64_t endGranule = preSkip + static_cast<int64_t>(samples_) * scale;
+
+    OggOpusWriter writer(opts_.serial, channels, static_cast<uint32_t>(opts_.rate), static_cast<uint16_t>(preSkip));
+    writer.WriteHeaders();
+    size_t k = 0;
+    for (const Segment &seg : segments)
+    {
+      size_t off = 0;
+      for (int len : seg.lens)
+      {
+        bool last = ++k == frames;
+        int64_t granule = last ? endGranule : static_cast<int64_t>(k) * F * scale;
+        writer.WritePacket(seg.bytes.data() + off, len, granule, last);
+        off += len;
+      }
+    }
+    ogg_ = writer.TakeData();
+  }
+
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    pcmRef_.Reset();
+    deferred_.Resolve(Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(ogg_.data()), ogg_.size()));
+  }
+
+  void OnError(const Napi::Error &e) override
+  {
+    pcmRef_.Reset();
+    deferred_.Reject(e.Value());
+  }
+
+private:
+  Napi::Promise::Deferred deferred_;
+  EncodeFileOptions opts_;
+  Napi::ObjectReference pcmRef_; // keeps the input alive while we read it
+  const opus_int16 *pcm_;
+  size_t samples_;
+  std::vector<unsigned char> ogg_;
+};
+
+// -----------------------------------------------------------------------------
+// AsyncWorker: Ogg parse, segment decode on the WorkerPool, stitch in place
+// -----------------------------------------------------------------------------
+struct DecodeFileOptions
+{
+  opus_int32 rate{48000};
+  int channels{0}; // 0 = from OpusHead
+  double segmentSeconds{kDefaultSegmentSeconds};
+  double preRollMs{kDefaultDecodePreRollMs};
+  std::string outPath; // write raw PCM here instead of returning it
+};
+
+class DecodeFileWorker : public Napi::AsyncWorker
+{
+public:
+  DecodeFileWorker(Napi::Env env, Napi::Buffer<unsigned char> ogg, const DecodeFileOptions &opts)
+      : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)), opts_(opts), ogg_(ogg.Data()),
+        oggLen_(ogg.Length())
+  {
+    oggRef_ = Napi::Persistent(ogg.As<Napi::Object>());
+  }
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+  struct Segment
+  {
+    size_t first{0}; // packet range [first, last)
+    size_t last{0};
+    int err{OPUS_OK};
+  };
+
+  void Execute() override
+  {
+    OggOpusReader reader;
+    if (!reader.Open(ogg_, oggLen_))
+    {
+      SetError(reader.Error());
+      return;
+    }
+    const OpusHeadInfo &head = reader.Head();
+    if (head.mappingFamily != 0 || head.channels > 2)
+    {
+      SetError("Only mono/stereo (mapping family 0) streams are supported");
+      return;
+    }
+    if (!opts_.channels)
+      opts_.channels = head.channels;
+
+    const opus_int32 R = opts_.rate;
+    const int C = opts_.channels;
+    const std::vector<OggOpusPacket> &packets = reader.Packets();
+
+    // Output position of every packet, so segments can decode in place.
+    std::vector<int64_t> start(packets.size() + 1, 0);
+    for (size_t i = 0; i < packets.size(); ++i)
+    {
+      int ns = packets[i].len ? opus_packet_get_nb_samples(packets[i].data, packets[i].len, R) : 0;
+      if (ns < 0)
+      {
+        SetError(StrError(ns));
+        return;
+      }
+      start[i + 1] = start[i] + ns;
+    }
+    const int64_t total = start.back();
+
+    // Segment boundaries fall on page boundaries.
+    const int64_t segSamples = std::max<int64_t>(1, static_cast<int64_t>(opts_.segmentSeconds * R));
+    std::vector<Segment> segments;
+    size_t segFirst = 0;
+    for (const OggPageInfo &page : reader.Pages())
+    {
+      if (page.packetEnd > segFirst && start[page.packetEnd] - start[segFirst] >= segSamples)
+      {
+        segments.push_back({segFirst, page.packetEnd, OPUS_OK});
+        segFirst = page.packetEnd;
+      }
+    }
+    if (segFirst < packets.size())
+      segments.push_back({segFirst, packets.size(), OPUS_OK});
+
+    pcm_.assign(static_cast<size_t>(total) * C, 0);
+    const int64_t preRoll = static_cast<int64_t>(opts_.preRollMs * R / 1000.0);
+
+    WorkerPool pool(FileJobThreads(segments.size()));
+    pool.Run(segments.size(), [&](size_t s) {
+      Segment &seg = segments[s];
+      int e;
+      OpusDecoder *dec = opus_decoder_create(R, C, &e);
+      if (e != OPUS_OK)
+      {
+        seg.err = e;
+        return;
+      }
+      if (head.outputGain)
+        opus_decoder_ctl(dec, OPUS_SET_GAIN(head.outputGain));
+
+      // Pre‑roll: decode and discard at least preRoll samples before the
+      // segment so the decoder has converged at its first kept sample.
+      size_t q = seg.first;
+      while (q > 0 && start[seg.first] - start[q] < preRoll)
+        --q;
+      std::vector<opus_int16> scratch(static_cast<size_t>(MAX_FRAME_SIZE) * C);
+      for (size_t i = q; i < seg.first; ++i)
+      {
+        if (packets[i].len)
+          opus_decode(dec, packets[i].data, packets[i].len, scratch.data(), MAX_FRAME_SIZE, 0);
+      }
+
+      for (size_t i = seg.first; i < seg.last; ++i)
+      {
+        int ns = static_cast<int>(start[i + 1] - start[i]);
+        if (!ns)
+          continue;
+        int got = opus_decode(dec, packets[i].data, packets[i].len, pcm_.data() + start[i] * C, ns, 0);
+        if (got < 0)
+        {
+          seg.err = got;
+          break;
+        }
+      }
+      opus_decoder_destroy(dec);
+    });
+
+    for (const Segment &seg : segments)
+    {
+      if (seg.err != OPUS_OK)
+      {
+        SetError(StrError(seg.err));
+        return;
+      }
+    }
+
+    // Trim pre‑skip at the front and the end padding given by the last granule.
+    const int64_t scale = 48000 / R;
+    offset_ = std::min<int64_t>(total, head.preSkip / scale);
+    samples_ = total - offset_;
+    if (reader.EndGranule() >= 0)
+    {
+      int64_t keep = (reader.EndGranule() - reader.StartGranule() - head.preSkip) / scale;
+      samples_ = std::max<int64_t>(0, std::min(samples_, keep));
+    }
+
+    if (!opts_.outPath.empty())
+    {
+      FILE *f = std::fopen(opts_.outPath.c_str(), "wb");
+      if (!f)
+      {
+        SetError("Failed to open output file");
+        return;
+      }
+      size_t count = static_cast<size_t>(samples_) * C;
+      size_t wrote = std::fwrite(pcm_.data() + offset_ * C, sizeof(opus_int16), count, f);
+      if (std::fclose(f) != 0 || wrote != count)
+        SetError("Failed to write output file");
+    }
+  }
+
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    oggRef_.Reset();
+    Napi::Object result = Napi::Object::New(env);
+    if (opts_.outPath.empty())
+    {
+      // Whole files can be hundreds of MB: hand the vector to the Buffer
+      // instead of copying it.
+      auto *pcm = new std::vector<opus_int16>(std::move(pcm_));
+      result.Set("pcm", Napi::Buffer<char>::New(
+                            env, reinterpret_cast<char *>(pcm->data() + offset_ * opts_.channels),
+                            static_cast<size_t>(samples_) * opts_.channels * sizeof(opus_int16),
+                            [](Napi::Env, char *, std::vector<opus_int16> *hint) { delete hint; }, pcm));
+    }
+    else
+      result.Set("pcm", env.Null());
+    result.Set("rate", Napi::Number::New(env, opts_.rate));
+    result.Set("channels", Napi::Number::New(env, opts_.channels));
+    result.Set("samples", Napi::Number::New(env, static_cast<double>(samples_)));
+    deferred_.Resolve(result);
+  }
+
+  void OnError(const Napi::Error &e) override
+  {
+    oggRef_.Reset();
+    deferred_.Reject(e.Value());
+  }
+
+private:
+  Napi::Promise::Deferred deferred_;
+  DecodeFileOptions opts_;
+  Napi::ObjectReference oggRef_;
+  const unsigned char *ogg_;
+  size_t oggLen_;
+  std::vector<opus_int16> pcm_;
+  int64_t offset_{0};  // samples per channel trimmed at the front
+  int64_t samples_{0}; // samples per channel kept
+};
+
+// -----------------------------------------------------------------------------
+// JS entry points
+// -----------------------------------------------------------------------------
+Napi::Value EncodeFileParallel(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsNumber() || !info[2].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (pcm: Buffer, rate: number, channels: number, options?: object)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  EncodeFileOptions opts;
+  opts.rate = info[1].ToNumber().Int32Value();
+  opts.channels = info[2].ToNumber().Int32Value();
+  if (!IsOpusRate(opts.rate) || opts.channels < 1 || opts.channels > 2)
+  {
+    Napi::RangeError::New(env, "Unsupported sample rate or channel count").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  opts.frameSize = opts.rate / 50;
+
+  if (info.Length() > 3 && info[3].IsObject())
+  {
+    Napi::Object o = info[3].As<Napi::Object>();
+    if (o.Get("bitrate").IsNumber())
+      opts.bitrate = o.Get("bitrate").ToNumber().Int32Value();
+    if (o.Get("complexity").IsNumber())
+      opts.complexity = o.Get("complexity").ToNumber().Int32Value();
+    if (o.Get("frameSize").IsNumber())
+      opts.frameSize = o.Get("frameSize").ToNumber().Int32Value();
+    if (o.Get("segmentSeconds").IsNumber())
+      opts.segmentSeconds = o.Get("segmentSeconds").ToNumber().DoubleValue();
+    if (o.Get("preRollMs").IsNumber())
+      opts.preRollMs = o.Get("preRollMs").ToNumber().DoubleValue();
+    if (o.Get("serial").IsNumber())
+      opts.serial = o.Get("serial").ToNumber().Uint32Value();
+  }
+
+  if (opts.frameSize <= 0 || opts.frameSize > MAX_FRAME_SIZE || opts.segmentSeconds <= 0 || opts.preRollMs < 0)
+  {
+    Napi::RangeError::New(env, "Invalid frameSize, segmentSeconds or preRollMs").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Buffer<char> pcm = info[0].As<Napi::Buffer<char>>();
+  if (pcm.Length() % (2 * opts.channels) != 0)
+  {
+    Napi::RangeError::New(env, "PCM buffer length must be multiple of (channels*2 bytes)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  EncodeFileWorker *worker = new EncodeFileWorker(env, pcm, opts);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value DecodeFileParallel(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsBuffer())
+  {
+    Napi::TypeError::New(env, "Expected (ogg: Buffer, options?: object)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DecodeFileOptions opts;
+  if (info.Length() > 1 && info[1].IsObject())
+  {
+    Napi::Object o = info[1].As<Napi::Object>();
+    if (o.Get("rate").IsNumber())
+      opts.rate = o.Get("rate").ToNumber().Int32Value();
+    if (o.Get("channels").IsNumber())
+      opts.channels = o.Get("channels").ToNumber().Int32Value();
+    if (o.Get("segmentSeconds").IsNumber())
+      opts.segmentSeconds = o.Get("segmentSeconds").ToNumber().DoubleValue();
+    if (o.Get("preRollMs").IsNumber())
+      opts.preRollMs = o.Get("preRollMs").ToNumber().DoubleValue();
+    if (o.Get("outPath").IsString())
+      opts.outPath = o.Get("outPath").ToString().Utf8Value();
+  }
+
+  if (!IsOpusRate(opts.rate) || opts.channels < 0 || opts.channels > 2)
+  {
+    Napi::RangeError::New(env, "Unsupported sample rate or channel count").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (opts.segmentSeconds <= 0 || opts.preRollMs < 0)
+  {
+    Napi::RangeError::New(env, "Invalid segmentSeconds or preRollMs").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DecodeFileWorker *worker = new DecodeFileWorker(env, info[0].As<Napi::Buffer<unsigned char>>(), opts);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+void InitFileCodec(Napi::Env env, Napi::Object exports)
+{
+  exports.Set("encodeFileParallel", Napi::Function::New(env, EncodeFileParallel, "encodeFileParallel"));
+  exports.Set("decodeFileParallel", Napi::Function::New(env, DecodeFileParallel, "decodeFileParallel"));
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <napi.h>
+
+// -----------------------------------------------------------------------------
+// Whole‑file codec helpers – run off the JS thread and resolve a Promise.
+// -----------------------------------------------------------------------------
+
+// encodeFileParallel(pcm, rate, channels, options?) -> Promise<Buffer>
+// Splits the PCM into segments encoded concurrently (each with pre‑roll) and
+// splices the packets into one Ogg Opus stream.
+Napi::Value EncodeFileParallel(const Napi::CallbackInfo &info);
+
+// decodeFileParallel(ogg, options?) -> Promise<{ pcm, rate, channels, samples }>
+// Splits the packet stream at page boundaries and decodes the segments
+// concurrently, each decoder starting ~80 ms early to converge.
+Napi::Value DecodeFileParallel(const Napi::CallbackInfo &info);
+
+void InitFileCodec(Napi::Env env, Napi::Object exports);
@@ -3,26 +3,724 @@ import path from "node:path";
 import { fileURLToPath } from "node:url";
 import nodeGypBuild from "node-gyp-build";
 
+/**
+ * Any binary input: Buffer, TypedArray or DataView (also over a
+ * SharedArrayBuffer), or an ArrayBuffer. Read in place, without copying.
+ */
+export type BinaryInput = Buffer | ArrayBufferView | ArrayBuffer;
+
 export interface OpusEncoder {
-  encode(buf: Buffer): Buffer;
+  encode(buf: BinaryInput): Buffer;
+  /**
+   * Encodes one frame and returns libopus' speech/music analysis for it
+   * (16, 24 or 48 kHz encoders only)
+   */
+  encodeWithAnalysis(buf: BinaryInput): { packet: Buffer; analysis: FrameAnalysis };
+  /** Runs only the analysis, without encoding the frame */
+  analyze(buf: BinaryInput): FrameAnalysis;
+  /**
+   * Encodes one frame and writes its metadata into `info`, indexed by
+   * `FrameInfo`
+   * @param info at least `FrameInfo.length` elements
+   */
+  encodeWithInfo(buf: BinaryInput, info: Int32Array): Buffer;
   /**
    * Decodes the given Opus buffer to PCM signed 16-bit little-endian
    * @param buf Opus buffer
    */
-  decode(buf: Buffer): Buffer;
+  decode(buf: BinaryInput): Buffer;
   applyEncoderCTL(ctl: number, value: number): void;
   applyDecoderCTL(ctl: number, value: number): void;
   setBitrate(bitrate: number): void;
   getBitrate(): number;
+  /**
+   * Bypasses the encoder on digital silence; `false` turns the gate off
+   */
+  setSilenceDetection(options: SilenceDetectionOptions | boolean): void;
+  getSilenceStats(): SilenceStats;
+  /**
+   * Adapts complexity (and optionally bandwidth) to keep p99 encode time under
+   * a budget; `"global"` joins the governor set by `setGlobalTimeBudget`.
+   * `false`/`null` detaches and restores the caller's complexity and max bandwidth
+   */
+  setTimeBudget(options: TimeBudgetOptions | "global" | false | null): void;
+  /** Null when no budget is attached */
+  getTimeBudgetStats(): TimeBudgetStats | null;
+  /**
+   * DRED history embedded in each packet, in 10 ms units (0–104). Needs a
+   * non-zero OPUS_SET_PACKET_LOSS_PERC and a build with `opus_dnn=1`
+   */
+  setDredDuration(frames: number): void;
+  /**
+   * Rebuilds the frames lost just before `packet` from its DRED data, oldest
+   * first; frames it does not reach are concealed with PLC. Decode `packet`
+   * itself with `decode` afterwards
+   */
+  decodeDred(packet: BinaryInput, lostFrames: number, frameSize: number): { pcm: Buffer; recovered: number };
+  /** Encoder lookahead (OPUS_GET_LOOKAHEAD), in samples at the encoder's rate */
+  readonly lookahead: number;
+}
+
+export interface OpusEncoderOptions {
+  /**
+   * `"audio"` (default), `"voip"`, or `"lowdelay"` (CELT only: lookahead drops
+   * from 6.5 ms to 2.5 ms, no SILK/hybrid speech modes); or an
+   * `OPUS_APPLICATION_*` value
+   */
+  application?: "audio" | "voip" | "lowdelay" | number;
+}
+
+export interface TimeBudgetOptions {
+  /** p99 wall time per encode call, in microseconds */
+  budgetUs: number;
+  minComplexity?: number;
+  maxComplexity?: number;
+  /** Frames per decision (default 100) */
+  windowFrames?: number;
+  /** Once at minComplexity, also lower OPUS_SET_MAX_BANDWIDTH down to wideband */
+  adaptBandwidth?: boolean;
+}
+
+export interface TimeBudgetStats {
+  complexity: number;
+  maxBandwidth: number;
+  /** p99 of the last decision window */
+  p99Us: number;
+  frames: number;
+  adjustments: number;
+  global: boolean;
+}
+
+/** Slots of the `Int32Array` filled by `encodeWithInfo` */
+export const FrameInfo = {
+  /** 0 SILK, 1 hybrid, 2 CELT, -1 no packet */
+  MODE: 0,
+  /** `OPUS_BANDWIDTH_*` of the packet */
+  BANDWIDTH: 1,
+  /** `OPUS_GET_FINAL_RANGE`; read with `>>> 0` for the unsigned value */
+  FINAL_RANGE: 2,
+  BYTES: 3,
+  /** 1 for DTX frames, including ones produced by `setSilenceDetection` */
+  DTX: 4,
+  /** Encoder lookahead in samples */
+  LOOKAHEAD: 5,
+  FRAME_SIZE: 6,
+  /** Bits per second spent on this frame */
+  BITRATE: 7,
+  length: 8,
+} as const;
+
+export interface FrameAnalysis {
+  /** False until the analyser has seen enough audio */
+  valid: boolean;
+  /** Voice activity probability, 0..1 */
+  vad: number;
+  /** Music (vs. speech) probability, 0..1 */
+  music: number;
+  activity: number;
+  tonality: number;
+  noisiness: number;
+  /** Highest active CELT band, 0..20 */
+  bandwidth: number;
+}
+
+export interface SilenceDetectionOptions {
+  /** Peak absolute sample value still treated as silence (default 0) */
+  threshold?: number;
+  /** Silent frames encoded normally before the encoder is bypassed (default 10) */
+  hangoverFrames?: number;
+  /** `"dtx"` emits TOC-only packets (1-2 bytes), `"skip"` emits empty buffers (default `"dtx"`) */
+  mode?: "dtx" | "skip";
+  /** In `"dtx"` mode, encode a real frame every N bypassed frames (default 20) */
+  refreshFrames?: number;
+  /** Also switch libopus DTX (`OPUS_SET_DTX`); left unchanged when omitted */
+  dtx?: boolean;
+}
+
+export interface SilenceStats {
+  silentFrames: number;
+  bypassedFrames: number;
+  inSilence: boolean;
+}
+
+export interface LadderEncoder {
+  /**
+   * Encodes one PCM frame at every configured bitrate, in parallel
+   * @param buf PCM signed 16-bit little-endian
+   * @returns one Opus packet per rung, in constructor order
+   */
+  encode(buf: BinaryInput): Buffer[];
+  applyEncoderCTL(ctl: number, value: number, rung?: number): void;
+  getBitrates(): number[];
+}
+
+export interface EncodeFileOptions {
+  /** Target bitrate in bits per second (default: libopus auto) */
+  bitrate?: number;
+  /** Encoder complexity 0-10 (default: libopus default) */
+  complexity?: number;
+  /** Samples per channel per packet (default: 20 ms) */
+  frameSize?: number;
+  /** Length of each independently encoded segment (default: 10) */
+  segmentSeconds?: number;
+  /** Audio encoded and discarded before each segment boundary (default: 200) */
+  preRollMs?: number;
+  /** Ogg bitstream serial number */
+  serial?: number;
+}
+
+export interface DecodeFileOptions {
+  /** Output sample rate (default: 48000) */
+  rate?: number;
+  /** Output channels (default: from the stream's OpusHead) */
+  channels?: number;
+  /** Target length of each independently decoded segment (default: 10) */
+  segmentSeconds?: number;
+  /** Audio decoded and discarded before each segment boundary (default: 80) */
+  preRollMs?: number;
+  /** Write the raw PCM to this path instead of returning it */
+  outPath?: string;
+}
+
+export interface DecodeFileResult {
+  /** PCM signed 16-bit little-endian, interleaved; null when `outPath` was given */
+  pcm: Buffer | null;
+  rate: number;
+  channels: number;
+  /** Samples per channel */
+  samples: number;
+}
+
+export interface SeekPosition {
+  /** Byte offset of the page to start reading from */
+  offset: number;
+  /** 48 kHz granule position of the first sample decoded from `offset` */
+  granule: number;
+  /** 48 kHz samples to decode and discard before the requested position */
+  preRoll: number;
+}
+
+export interface OggSeekIndex {
+  /**
+   * Finds where to resume decoding for a playback position, leaving at least
+   * 80 ms of decoder pre-roll
+   * @param positionMs position in milliseconds from the start of playback
+   */
+  seek(positionMs: number): SeekPosition;
+  /** Serializes the index; pass the result back to the constructor to reload it */
+  save(): Buffer;
+  /** Playback duration in milliseconds */
+  readonly duration: number;
+  /** Number of resume points in the table */
+  readonly pageCount: number;
+}
+
+export interface EncoderFarmOptions {
+  /** Samples per channel encoded per stream per tick (default: 20 ms) */
+  frameSize?: number;
+  /** OPUS_APPLICATION_* value (default: OPUS_APPLICATION_AUDIO) */
+  application?: number;
+}
+
+export interface EncoderFarm {
+  /** Adds a stream and returns its id; ids of removed streams are reused */
+  add(bitrate?: number): number;
+  remove(id: number): void;
+  setBitrate(id: number, bitrate: number): void;
+  applyEncoderCTL(id: number, ctl: number, value: number): void;
+  /**
+   * Encodes one frame for every active stream. Slot `id` of `pcmSlab` is read
+   * at `id * pcmStride`, its packet written at `id * outStride` of `outSlab`,
+   * and its length (0 if inactive, negative on error) stored in `lengths[id]`
+   * @returns number of packets produced
+   */
+  tickAll(pcmSlab: Buffer, outSlab: Buffer, lengths: Int32Array, parallel?: boolean): number;
+  /** Bytes of PCM per stream slot */
+  readonly pcmStride: number;
+  /** Bytes of output per stream slot */
+  readonly outStride: number;
+  readonly activeCount: number;
+}
+
+export interface CodecPoolOptions {
+  /** Number of codec threads (default: half the hardware threads) */
+  threads?: number;
+  /** Pin thread i to CPU i (Linux only, best effort) */
+  pinThreads?: boolean;
+}
+
+export interface CodecPoolStats {
+  threads: number;
+  /** Jobs waiting in all queues */
+  queued: number;
+  /** Jobs waiting per thread queue */
+  queueDepths: number[];
+  /** Highest `queued` value seen */
+  maxQueued: number;
+  /** Jobs submitted and not yet settled */
+  inFlight: number;
+  completed: number;
+  /** Jobs that finished after their due time */
+  missedDeadlines: number;
+  worstLatenessMs: number;
+  /** Jobs run by a thread other than the one they were queued on */
+  stolen: number;
+}
+
+export interface CodecPool {
+  /**
+   * Encodes on a pool thread, earliest deadline first
+   * @param dueMs milliseconds from now when the packet is due (default: 20)
+   */
+  encode(encoder: OpusEncoder, pcm: BinaryInput, dueMs?: number): Promise<Buffer>;
+  decode(encoder: OpusEncoder, packet: BinaryInput, dueMs?: number): Promise<Buffer>;
+  stats(): CodecPoolStats;
+  /** Refuses new jobs; resolves once queued jobs are done and the threads have exited */
+  close(): Promise<void>;
+}
+
+export interface PcmRing {
+  /** Appends one record; returns false if the ring is full */
+  write(data: ArrayBufferView): boolean;
+  /** Removes and returns the oldest record, or null if the ring is empty; throws if the ring is corrupt */
+  read(): Buffer | null;
+  /** Bytes currently queued, including record headers */
+  readonly used: number;
+  /** Size of the data area in bytes */
+  readonly capacity: number;
+}
+
+export interface RingEncoderStats {
+  running: boolean;
+  frames: number;
+  errors: number;
+  /** Times the encoder thread had to wait for space in the output ring */
+  outputStalls: number;
+  /** The input ring held an out-of-range record or index; the thread stopped reading it */
+  inputCorrupt: boolean;
+}
+
+export interface RingEncoder {
+  /** Starts the native encoder thread */
+  start(): void;
+  /** Stops and joins the native encoder thread */
+  stop(): void;
+  /** Only allowed while stopped */
+  applyEncoderCTL(ctl: number, value: number): void;
+  stats(): RingEncoderStats;
+}
+
+export interface ClipCacheStats {
+  hits: number;
+  misses: number;
+  evictions: number;
+  entries: number;
+  bytes: number;
+  maxBytes: number;
+}
+
+export interface ClipCache {
+  /**
+   * Encodes a whole clip from a freshly reset encoder state, or returns the
+   * stored packets if the same PCM was encoded with the same configuration
+   * @param pcm PCM signed 16-bit little-endian; the last frame is zero-padded
+   * @param frameSize samples per channel per packet (default: 20 ms)
+   */
+  encode(encoder: OpusEncoder, pcm: BinaryInput, frameSize?: number): Buffer[];
+  stats(): ClipCacheStats;
+  clear(): void;
+}
+
+export interface RateControllerOptions {
+  minBitrate?: number;
+  maxBitrate?: number;
+  /** Default: halfway between min and max; must lie within them */
+  startBitrate?: number;
+  /** EWMA weight of the newest report, 0..1 (default 0.3) */
+  smoothing?: number;
+  /** Smoothed loss above which bitrate backs off (default 0.10) */
+  highLoss?: number;
+  /** Smoothed loss below which bitrate probes upwards (default 0.02) */
+  lowLoss?: number;
+  /** Smoothed jitter treated as queue build-up (default 40) */
+  highJitterMs?: number;
+  /** Minimum time between upward steps; stretched to 2 × smoothed RTT (default 1000) */
+  increaseIntervalMs?: number;
+  increaseFactor?: number;
+  /** Drive OPUS_SET_INBAND_FEC (default true) */
+  fec?: boolean;
+  fecOnLoss?: number;
+  fecOffLoss?: number;
+  maxLossPerc?: number;
+  /** `"auto"` enables DTX only while congested (default) */
+  dtx?: boolean | "auto";
+  /** Suggest 40/60 ms packets at low bitrates (default true) */
+  adaptFrameSize?: boolean;
+}
+
+export interface RateReport {
+  /** Fraction of packets lost since the last report, 0..1 */
+  loss?: number;
+  rttMs?: number;
+  jitterMs?: number;
+  /** Report time; defaults to a monotonic clock */
+  nowMs?: number;
+}
+
+export interface RateDecision {
+  bitrate: number;
+  fec: boolean;
+  lossPerc: number;
+  dtx: boolean;
+  /** Suggested packet duration; size the PCM passed to encode() accordingly */
+  frameMs: number;
+  congested: boolean;
+}
+
+export interface RateSimulationStep extends RateReport {
+  /** Bottleneck capacity; when set, loss is derived from the current bitrate */
+  capacityKbps?: number;
+}
+
+export interface RateController {
+  /** Smooths the report, applies bitrate/FEC/loss/DTX CTLs to the encoder */
+  report(report: RateReport): RateDecision;
+  readonly decision: RateDecision;
+}
+
+export interface RtpPacketizerOptions {
+  /** Default: random */
+  ssrc?: number;
+  /** Default: 111 */
+  payloadType?: number;
+  /** Initial sequence number; default random */
+  sequence?: number;
+  /** Initial timestamp (48 kHz clock); default random */
+  timestamp?: number;
+  /** RFC 8285 one-byte extension id for RFC 6464 audio level (default 1) */
+  audioLevelId?: number;
+  /**
+   * RFC 2198 redundancy: each packet also carries the previous `distance`
+   * frames (1..3, default 1) under the RED `payloadType`
+   */
+  red?: { payloadType: number; distance?: number };
+}
+
+export interface RtpPacketizer {
+  /**
+   * Encodes one frame and returns it as a complete RTP packet; empty if the
+   * encoder produced nothing (silence `skip` mode)
+   * @param options.audioLevel RFC 6464 level in -dBov (0..127)
+   */
+  packetize(pcm: BinaryInput, options?: { marker?: boolean; audioLevel?: number; voice?: boolean }): Buffer;
+  /**
+   * Parses the RTP header and decodes the payload with the encoder's decoder.
+   * Audio lost since the previous packet is recovered from RED copies or
+   * concealed, and returned ahead of this packet's frame; late or duplicate
+   * packets return an empty Buffer
+   */
+  depacketize(packet: BinaryInput): Buffer;
+  /** Packets decoded, frames recovered from RED, PLC runs */
+  stats(): { received: number; recovered: number; concealed: number };
+  /** Next sequence number */
+  readonly sequence: number;
+  /** Next timestamp */
+  readonly timestamp: number;
+  readonly ssrc: number;
+}
+
+/** Slots per packet in the `Int32Array` filled by `RtpPacketizer.parseBatch` */
+export const RtpInfo = {
+  PAYLOAD_OFFSET: 0,
+  /** -1 if the packet is malformed */
+  PAYLOAD_LENGTH: 1,
+  SEQUENCE: 2,
+  /** Read with `>>> 0` */
+  TIMESTAMP: 3,
+  /** Read with `>>> 0` */
+  SSRC: 4,
+  PAYLOAD_TYPE: 5,
+  MARKER: 6,
+  /** -1 if absent */
+  AUDIO_LEVEL: 7,
+  stride: 8,
+} as const;
+
+export interface UdpTransportOptions {
+  /** Local address to bind (default "0.0.0.0"); IPv6 literals select an IPv6 socket */
+  address?: string;
+  /** Default 0 (ephemeral) */
+  port?: number;
+  /** Coalesce equal-size packets to one peer with UDP GSO when available (default true) */
+  gso?: boolean;
+}
+
+export interface UdpTransportStats {
+  packetsSent: number;
+  packetsReceived: number;
+  sendCalls: number;
+  recvCalls: number;
+  gsoMessages: number;
+  gso: boolean;
+  queued: number;
+  /** Messages dropped because the kernel rejected them */
+  sendErrors: number;
+  /** `sendErrors` by peer id */
+  peerErrors: number[];
+  lastError: string | null;
+}
+
+export interface UdpTransport {
+  /** Registers a destination; returns its peer id */
+  addPeer(address: string, port: number): number;
+  /** Copies a packet into the native send queue; returns the queue length */
+  queue(packet: BinaryInput, peer: number): number;
+  /**
+   * Queues `lengths[i]` bytes at `slab[i * stride]` for `peers[i]`
+   * (e.g. `EncoderFarm.tickAll` output); non-positive lengths and negative peers are skipped
+   */
+  queueSlab(slab: BinaryInput, stride: number, lengths: Int32Array, peers: Int32Array): number;
+  /**
+   * Sends the queue with sendmmsg; returns packets sent (the rest stays queued
+   * on EAGAIN). Messages the kernel rejects are dropped and counted per peer;
+   * throws only if nothing could be sent
+   */
+  flush(): number;
+  /**
+   * Drains the socket with recvmmsg: datagram i lands at `slab[i * stride]`
+   * (stride default 1500), `lengths[i]` is its size or -1 if truncated
+   */
+  receive(slab: BinaryInput, lengths: Int32Array, stride?: number): number;
+  /**
+   * Drains the socket and decodes each packet with the encoder's decoder,
+   * RTP-reordered within the batch; `pcmSlab` is split into `maxPackets` slots
+   * and `samples[i]` receives the per-channel sample count (or an error code)
+   */
+  receiveDecode(
+    encoder: OpusEncoder,
+    pcmSlab: BinaryInput,
+    samples: Int32Array,
+    options?: { rtp?: boolean; maxPackets?: number },
+  ): number;
+  stats(): UdpTransportStats;
+  close(): void;
+  /** Bound local port */
+  readonly port: number | null;
+}
+
+export interface OggRecorderOptions {
+  /** How often queued pages are written (default 1000) */
+  flushIntervalMs?: number;
+  /** fdatasync dirty files this often; 0 = only on close (default 0) */
+  fsyncIntervalMs?: number;
+  /** Default true */
+  fsyncOnClose?: boolean;
+  /** Queued bytes that trigger a write before the interval (default 1 MiB) */
+  highWaterBytes?: number;
+}
+
+export interface OggRecorder {
+  /** Creates (truncates) `path` and returns a stream id */
+  open(path: string, options?: { channels?: number; rate?: number; preSkip?: number; serial?: number }): number;
+  write(id: number, packet: BinaryInput): void;
+  /** `EncoderFarm.tickAll` slab layout; non-positive lengths and negative ids are skipped */
+  writeBatch(slab: BinaryInput, stride: number, lengths: Int32Array, ids: Int32Array): number;
+  /** Marks the last page EOS; the file is closed by the next write round */
+  closeStream(id: number): void;
+  /** Settles once everything written so far is on disk (and synced, with `sync`) */
+  flush(sync?: boolean): Promise<void>;
+  stats(): {
+    streams: number;
+    queuedBytes: number;
+    packets: number;
+    bytesWritten: number;
+    writeCalls: number;
+    fsyncs: number;
+    errors: number;
+    lastError: string | null;
+  };
+  /** Ends every recording; settles once the files are written and the I/O thread has stopped */
+  close(): Promise<void>;
+}
+
+export interface OggEditOptions {
+  /** Packets decoded and discarded ahead of a cut point (default 80, RFC 7845) */
+  preRollMs?: number;
+  /** Ogg serial of the output stream (default: random) */
+  serial?: number;
+}
+
+export type OggEditPart = BinaryInput | string | { source: BinaryInput | string; startMs?: number; endMs?: number };
+
+export interface PcmIngestOptions {
+  /** Input sample rate (default 48000) */
+  rate?: number;
+  /** Input channels (default 2) */
+  channels?: number;
+  /** Samples per channel per packet (default 20 ms) */
+  frameSize?: number;
+  /** OPUS_APPLICATION_* value (default: OPUS_APPLICATION_AUDIO) */
+  application?: number;
+  bitrate?: number;
+  complexity?: number;
+  /** Packets per `onData` call (default 50) */
+  batchFrames?: number;
+  /** `'packets'` (default) or `'ogg'` pages */
+  format?: "packets" | "ogg";
+  /** Write an Ogg Opus file here instead of calling `onData` */
+  outPath?: string;
+  /** Ogg stream serial number */
+  serial?: number;
+}
+
+export interface PcmIngest {
+  /**
+   * Starts the reader thread. In packet mode `onData(packets, lengths)` gets
+   * the batch back to back; in Ogg mode `onData(pages)`. Resolves at EOF or
+   * after `stop()`, once the tail has been flushed
+   */
+  start(
+    onData?: (data: Buffer, lengths?: Int32Array) => void,
+  ): Promise<{ bytesRead: number; frames: number; samples: number }>;
+  /** Ends the stream as if EOF had been reached (noticed within 100 ms) */
+  stop(): void;
+  stats(): { running: boolean; bytesRead: number; frames: number; batches: number };
+}
+
+export interface OpusCustomEncoderOptions {
+  /** bits/s (default 64000 per channel) */
+  bitrate?: number;
+  complexity?: number;
+}
+
+export interface OpusCustomEncoder {
+  /** @param pcm exactly `frameSize` samples per channel, 16-bit interleaved */
+  encode(pcm: BinaryInput): Buffer;
+  /** `null` conceals one lost frame */
+  decode(packet: BinaryInput | null): Buffer;
+  setBitrate(bitrate: number): void;
+  applyEncoderCTL(ctl: number, value: number): void;
+  readonly frameSize: number;
+  /** Algorithmic delay (frame + MDCT overlap), in samples */
+  readonly delay: number;
+  readonly delayMs: number;
 }
 
 export interface OpusBinding {
-  OpusEncoder: new (rate: number, channels: number) => OpusEncoder;
+  OpusEncoder: {
+    new (rate: number, channels: number, options?: OpusEncoderOptions): OpusEncoder;
+    /** Configures the process-wide governor shared by `setTimeBudget("global")` encoders */
+    setGlobalTimeBudget(options: TimeBudgetOptions | false): void;
+  };
+  LadderEncoder: new (rate: number, channels: number, bitrates: number[]) => LadderEncoder;
+  /**
+   * Encodes a whole PCM signal into an Ogg Opus file, using one encoder per
+   * segment across all cores
+   * @param pcm PCM signed 16-bit little-endian, interleaved
+   */
+  encodeFileParallel(pcm: Buffer, rate: number, channels: number, options?: EncodeFileOptions): Promise<Buffer>;
+  /**
+   * Decodes a whole Ogg Opus file, splitting it at page boundaries and
+   * decoding the segments concurrently
+   * @param ogg Ogg Opus file contents
+   */
+  decodeFileParallel(ogg: Buffer, options?: DecodeFileOptions): Promise<DecodeFileResult>;
+  /**
+   * Cuts [startMs, endMs) out of an Ogg Opus file or Buffer without
+   * re-encoding: whole packets plus pre-roll, trimmed by pre-skip and end granule
+   */
+  cutOggOpus(source: BinaryInput | string, startMs: number, endMs?: number, options?: OggEditOptions): Buffer;
+  /**
+   * Joins (optionally cut) parts into one Ogg Opus stream. Inner joins are only
+   * packet-accurate: an inner startMs/endMs off a packet boundary throws. Parts
+   * must share channel count and output gain
+   */
+  concatOggOpus(parts: OggEditPart[], options?: OggEditOptions): Buffer;
+  /** Builds a seek index from a file path, Ogg Opus contents, or a saved index */
+  OggSeekIndex: new (source: string | Buffer) => OggSeekIndex;
+  /** Playback duration in milliseconds, reading only the first and last pages */
+  getOggOpusDuration(path: string): number;
+  EncoderFarm: new (rate: number, channels: number, capacity: number, options?: EncoderFarmOptions) => EncoderFarm;
+  CodecPool: new (options?: CodecPoolOptions) => CodecPool;
+  PcmRing: {
+    /** @param view Uint8Array over a SharedArrayBuffer of `PcmRing.byteLength(capacity)` bytes */
+    new (view: Uint8Array): PcmRing;
+    /** Bytes of shared memory needed for a ring with at least `capacity` data bytes */
+    byteLength(capacity: number): number;
+  };
+  RingEncoder: new (rate: number, channels: number, input: Uint8Array, output: Uint8Array) => RingEncoder;
+  /** @param options.maxBytes memory budget (default: 64 MiB) */
+  ClipCache: new (options?: { maxBytes?: number }) => ClipCache;
+  RtpPacketizer: {
+    new (encoder: OpusEncoder, options?: RtpPacketizerOptions): RtpPacketizer;
+    /**
+     * Parses many RTP headers in one call
+     * @param info `RtpInfo.stride` slots per packet
+     * @returns number of well-formed packets
+     */
+    parseBatch(packets: BinaryInput[], info: Int32Array, audioLevelId?: number): number;
+  };
+  /** Linux only; the constructor throws elsewhere */
+  UdpTransport: new (options?: UdpTransportOptions) => UdpTransport;
+  /** POSIX only; the constructor throws elsewhere. The fd is not closed; a path is */
+  PcmIngest: new (source: number | string, options?: PcmIngestOptions) => PcmIngest;
+  /** POSIX only; the constructor throws elsewhere */
+  OggRecorder: new (options?: OggRecorderOptions) => OggRecorder;
+  /**
+   * Opus custom mode; packets are not standard Opus. Only in builds with
+   * `opus_custom_modes=1` (see `customModes`); the constructor throws elsewhere
+   */
+  OpusCustomEncoder: new (
+    rate: number,
+    channels: number,
+    frameSize: number,
+    options?: OpusCustomEncoderOptions,
+  ) => OpusCustomEncoder;
+  customModes: boolean;
+  /** True when built with `opus_dnn=1` (DRED, deep PLC and OSCE) */
+  dnn: boolean;
+  /** True when built with `opus_fixed_point=1` */
+  fixedPoint: boolean;
+  RateController: {
+    new (encoder: OpusEncoder, options?: RateControllerOptions): RateController;
+    /**
+     * Runs the policy over a scripted trace, one step per `intervalMs`
+     * (default 1000), without an encoder; deterministic
+     */
+    simulate(
+      options: (RateControllerOptions & { overheadKbps?: number }) | undefined,
+      trace: RateSimulationStep[],
+      intervalMs?: number,
+    ): (RateDecision & { loss: number; smoothedLoss: number })[];
+  };
 }
 
 // Pass the **package root** to node-gyp-build, not lib/
 const moduleDir = path.dirname(fileURLToPath(import.meta.url));
 const binding = nodeGypBuild(path.resolve(moduleDir, "..")) as OpusBinding;
 
-export const { OpusEncoder } = binding;
+export const {
+  OpusEncoder,
+  LadderEncoder,
+  encodeFileParallel,
+  decodeFileParallel,
+  cutOggOpus,
+  concatOggOpus,
+  OggSeekIndex,
+  getOggOpusDuration,
+  EncoderFarm,
+  CodecPool,
+  PcmRing,
+  RingEncoder,
+  ClipCache,
+  RateController,
+  RtpPacketizer,
+  UdpTransport,
+  PcmIngest,
+  OggRecorder,
+  OpusCustomEncoder,
+  customModes,
+  dnn,
+  fixedPoint,
+} = binding;
 export default binding;
@@ -0,0 +1,186 @@
+// ladder-encoder.cc – simulcast bitrate ladder on top of libopus.
+
+#include "ladder-encoder.h"
+#include "byte-view.h"
+#include "worker-pool.h"
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// -----------------------------------------------------------------------------
+LadderEncoderWrap::LadderEncoderWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<LadderEncoderWrap>(info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsArray())
+  {
+    Napi::TypeError::New(env, "Expected (rate: number, channels: number, bitrates: number[])").ThrowAsJavaScriptException();
+    return;
+  }
+
+  rate_ = info[0].ToNumber().Int32Value();
+  channels_ = info[1].ToNumber().Int32Value();
+
+  Napi::Array bitrates = info[2].As<Napi::Array>();
+  if (bitrates.Length() == 0)
+  {
+    Napi::RangeError::New(env, "At least one bitrate is required").ThrowAsJavaScriptException();
+    return;
+  }
+
+  rungs_.resize(bitrates.Length());
+  for (uint32_t i = 0; i < bitrates.Length(); ++i)
+  {
+    Napi::Value br = bitrates.Get(i);
+    if (!br.IsNumber())
+    {
+      Napi::TypeError::New(env, "Bitrates must be numbers").ThrowAsJavaScriptException();
+      return;
+    }
+
+    int err;
+    rungs_[i].enc = opus_encoder_create(rate_, channels_, OPUS_APPLICATION_AUDIO, &err);
+    if (err != OPUS_OK)
+    {
+      rungs_[i].enc = nullptr;
+      Napi::Error::New(env, "Failed to create libopus encoder (bad params?)").ThrowAsJavaScriptException();
+      return;
+    }
+    rungs_[i].out = new unsigned char[MAX_PACKET_SIZE]();
+
+    int rc = opus_encoder_ctl(rungs_[i].enc, OPUS_SET_BITRATE(br.ToNumber().Int32Value()));
+    if (rc != OPUS_OK)
+    {
+      Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+      return;
+    }
+  }
+}
+
+LadderEncoderWrap::~LadderEncoderWrap()
+{
+  for (Rung &r : rungs_)
+  {
+    if (r.enc)
+      opus_encoder_destroy(r.enc);
+    delete[] r.out;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Encode PCM -> one Opus packet per rung (returns Buffer[])
+// -----------------------------------------------------------------------------
+Napi::Value LadderEncoderWrap::Encode(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  ByteView view;
+  if (info.Length() < 1 || !GetByteView(env, info[0], &view))
+  {
+    Napi::TypeError::New(env, "Argument must be a Buffer, TypedArray, DataView or ArrayBuffer containing 16‑bit PCM")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Validate once for the whole ladder.
+  if (view.length % (2 * channels_) != 0)
+  {
+    Napi::RangeError::New(env, "PCM buffer length must be multiple of (channels*2 bytes)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const opus_int16 *pcm = AlignedPcm(view, &inPcm_);
+  int frameSize = view.length / 2 / channels_;
+  if (frameSize > MAX_FRAME_SIZE)
+  {
+    Napi::RangeError::New(env, "Frame exceeds MAX_FRAME_SIZE").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  WorkerPool::Shared().Run(rungs_.size(), [&](size_t i) {
+    Rung &r = rungs_[i];
+    r.len = opus_encode(r.enc, pcm, frameSize, r.out, MAX_PACKET_SIZE);
+  });
+
+  Napi::Array result = Napi::Array::New(env, rungs_.size());
+  for (uint32_t i = 0; i < rungs_.size(); ++i)
+  {
+    const Rung &r = rungs_[i];
+    if (r.len < 0)
+    {
+      Napi::Error::New(env, StrError(r.len)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    result.Set(i, Napi::Buffer<char>::Copy(env, reinterpret_cast<char *>(r.out), r.len));
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// CTL on every rung, or on one rung when an index is given
+// -----------------------------------------------------------------------------
+Napi::Value LadderEncoderWrap::ApplyEncoderCTL(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNumber()))
+  {
+    Napi::TypeError::New(env, "Expected (ctl: number, value: number, rung?: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int ctl = info[0].ToNumber().Int32Value();
+  int value = info[1].ToNumber().Int32Value();
+  size_t first = 0, last = rungs_.size();
+  if (info.Length() > 2 && info[2].IsNumber())
+  {
+    int64_t rung = info[2].ToNumber().Int64Value();
+    if (rung < 0 || static_cast<size_t>(rung) >= rungs_.size())
+    {
+      Napi::RangeError::New(env, "Rung index out of range").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    first = static_cast<size_t>(rung);
+    last = first + 1;
+  }
+
+  for (size_t i = first; i < last; ++i)
+  {
+    int rc = opus_encoder_ctl(rungs_[i].enc, ctl, value);
+    if (rc != OPUS_OK)
+    {
+      Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  return Napi::Number::New(env, OPUS_OK);
+}
+
+Napi::Value LadderEncoderWrap::GetBitrates(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Array result = Napi::Array::New(env, rungs_.size());
+  for (uint32_t i = 0; i < rungs_.size(); ++i)
+  {
+    opus_int32 br = 0;
+    int rc = opus_encoder_ctl(rungs_[i].enc, OPUS_GET_BITRATE(&br));
+    if (rc != OPUS_OK)
+    {
+      Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    result.Set(i, Napi::Number::New(env, br));
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object LadderEncoderWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<LadderEncoderWrap>::DefineClass(env, "LadderEncoder", {
+                                                                                                   InstanceMethod("encode", &LadderEncoderWrap::Encode),
+                                                                                                   InstanceMethod("applyEncoderCTL", &LadderEncoderWrap::ApplyEncoderCTL),
+                                                                                                   InstanceMethod("getBitrates", &LadderEncoderWrap::GetBitrates),
+                                                                                               });
+  exports.Set("LadderEncoder", ctor);
+  return exports;
+}
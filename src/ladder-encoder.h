@@ -0,0 +1,37 @@
+#pragma once
+
+#include <napi.h>
+#include <vector>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// LadderEncoder – one PCM frame in, one packet per configured bitrate out.
+// Every rung owns its own libopus encoder; rungs are encoded in parallel on the
+// shared WorkerPool so a frame costs roughly as much as its slowest rung.
+// -----------------------------------------------------------------------------
+class LadderEncoderWrap : public Napi::ObjectWrap<LadderEncoderWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  LadderEncoderWrap(const Napi::CallbackInfo &);
+  ~LadderEncoderWrap();
+
+private:
+  struct Rung
+  {
+    OpusEncoder *enc{nullptr};
+    unsigned char *out{nullptr}; // MAX_PACKET_SIZE
+    opus_int32 len{0};           // last packet length or libopus error
+  };
+
+  // JS‑exposed methods
+  Napi::Value Encode(const Napi::CallbackInfo &);
+  Napi::Value ApplyEncoderCTL(const Napi::CallbackInfo &);
+  Napi::Value GetBitrates(const Napi::CallbackInfo &);
+
+  // Members
+  opus_int32 rate_{0};
+  int channels_{0};
+  std::vector<Rung> rungs_;
+  std::vector<opus_int16> inPcm_; // aligned copy of odd‑offset input views
+};
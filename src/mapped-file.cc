@@ -0,0 +1,116 @@
+// mapped-file.cc – read‑only file mapping for the Ogg scanners.
+
+#include "mapped-file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string &path)
+{
+  Close();
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    error_ = "Failed to open file";
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size))
+  {
+    CloseHandle(file);
+    error_ = "Failed to stat file";
+    return false;
+  }
+  file_ = file;
+  size_ = static_cast<size_t>(size.QuadPart);
+  if (!size_)
+    return true;
+
+  mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping_)
+  {
+    Close();
+    error_ = "Failed to map file";
+    return false;
+  }
+  data_ = static_cast<const unsigned char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!data_)
+  {
+    Close();
+    error_ = "Failed to map file";
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (data_)
+    UnmapViewOfFile(data_);
+  if (mapping_)
+    CloseHandle(mapping_);
+  if (file_)
+    CloseHandle(file_);
+  data_ = nullptr;
+  mapping_ = nullptr;
+  file_ = nullptr;
+  size_ = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string &path)
+{
+  Close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    error_ = "Failed to open file";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    error_ = "Failed to stat file";
+    return false;
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_)
+  {
+    void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+    {
+      ::close(fd);
+      size_ = 0;
+      error_ = "Failed to map file";
+      return false;
+    }
+    data_ = static_cast<const unsigned char *>(p);
+  }
+  ::close(fd); // the mapping keeps its own reference
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (data_)
+    munmap(const_cast<unsigned char *>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif
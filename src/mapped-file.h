@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// -----------------------------------------------------------------------------
+// MappedFile – read‑only memory map of a whole file (mmap / MapViewOfFile).
+// Pages are only faulted in when touched, so header scans stay cheap.
+// -----------------------------------------------------------------------------
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Returns false and sets Error() on failure. Empty files map to size 0.
+  bool Open(const std::string &path);
+  void Close();
+
+  const unsigned char *Data() const { return data_; }
+  size_t Size() const { return size_; }
+  const std::string &Error() const { return error_; }
+
+private:
+  const unsigned char *data_{nullptr};
+  size_t size_{0};
+  std::string error_;
+#ifdef _WIN32
+  void *file_{nullptr};
+  void *mapping_{nullptr};
+#endif
+};
@@ -3,75 +3,26 @@
 // Build this as part of the node‑gyp addon (binding name: opus).
 
 #include <napi.h>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
-#include "../libopus/opus/include/opus.h"
-
-// -----------------------------------------------------------------------------
-// Constants (keep in sync with your JavaScript layer)
-// -----------------------------------------------------------------------------
-static constexpr int MAX_FRAME_SIZE = 5760;  // 120 ms @ 48 kHz mono
-static constexpr int MAX_PACKET_SIZE = 1276; // per Opus spec
-
-// -----------------------------------------------------------------------------
-// Utility: translate libopus error codes to strings
-// -----------------------------------------------------------------------------
-static const char *StrError(int code)
-{
-  switch (code)
-  {
-  case OPUS_OK:
-    return "OK";
-  case OPUS_BAD_ARG:
-    return "One or more invalid/out‑of‑range arguments";
-  case OPUS_BUFFER_TOO_SMALL:
-    return "Buffer too small";
-  case OPUS_INTERNAL_ERROR:
-    return "Internal libopus error";
-  case OPUS_INVALID_PACKET:
-    return "Corrupted compressed data";
-  case OPUS_UNIMPLEMENTED:
-    return "Invalid/unsupported request";
-  case OPUS_INVALID_STATE:
-    return "Encoder/decoder in invalid state";
-  case OPUS_ALLOC_FAIL:
-    return "Memory allocation failed";
-  default:
-    return "Unknown libopus error";
-  }
-}
-
-// -----------------------------------------------------------------------------
-// OpusEncoder class – JS visible
-// -----------------------------------------------------------------------------
-class OpusEncoderWrap : public Napi::ObjectWrap<OpusEncoderWrap>
-{
-public:
-  static Napi::Object Init(Napi::Env env, Napi::Object exports);
-  OpusEncoderWrap(const Napi::CallbackInfo &);
-  ~OpusEncoderWrap();
-
-private:
-  // JS‑exposed methods
-  Napi::Value Encode(const Napi::CallbackInfo &);
-  Napi::Value Decode(const Napi::CallbackInfo &);
-  Napi::Value ApplyEncoderCTL(const Napi::CallbackInfo &);
-  Napi::Value ApplyDecoderCTL(const Napi::CallbackInfo &);
-  Napi::Value SetBitrate(const Napi::CallbackInfo &);
-  Napi::Value GetBitrate(const Napi::CallbackInfo &);
-
-  // Helpers
-  int EnsureEncoder();
-  int EnsureDecoder();
-
-  // Members
-  opus_int32 rate_{0};
-  int channels_{0};
-  int application_{OPUS_APPLICATION_AUDIO};
-  OpusEncoder *enc_{nullptr};
-  OpusDecoder *dec_{nullptr};
-  opus_int16 *outPcm_{nullptr};     // MAX_FRAME_SIZE * channels_
-  unsigned char *outOpus_{nullptr}; // MAX_PACKET_SIZE
-};
+#include <string>
+#include "node-opus.h"
+#include "byte-view.h"
+#include "clip-cache.h"
+#include "codec-pool.h"
+#include "custom-encoder.h"
+#include "encoder-farm.h"
+#include "file-codec.h"
+#include "ladder-encoder.h"
+#include "ogg-edit.h"
+#include "ogg-recorder.h"
+#include "pcm-ingest.h"
+#include "rate-controller.h"
+#include "rtp.h"
+#include "seek-index.h"
+#include "shared-ring.h"
+#include "udp-transport.h"
 
 // -----------------------------------------------------------------------------
 // Constructor / destructor
@@ -87,6 +38,28 @@ OpusEncoderWrap::OpusEncoderWrap(const Napi::CallbackInfo &info) : Napi::ObjectW
   rate_ = info[0].ToNumber().Int32Value();
   channels_ = info[1].ToNumber().Int32Value();
 
+  // new OpusEncoder(rate, channels, { application: 'audio' | 'voip' | 'lowdelay' | OPUS_APPLICATION_* })
+  if (info.Length() > 2 && info[2].IsObject())
+  {
+    Napi::Value app = info[2].As<Napi::Object>().Get("application");
+    if (app.IsString())
+    {
+      std::string name = app.ToString().Utf8Value();
+      application_ = name == "voip"       ? OPUS_APPLICATION_VOIP
+                     : name == "audio"    ? OPUS_APPLICATION_AUDIO
+                     : name == "lowdelay" ? OPUS_APPLICATION_RESTRICTED_LOWDELAY
+                                          : -1;
+    }
+    else if (app.IsNumber())
+      application_ = app.ToNumber().Int32Value();
+    if (application_ != OPUS_APPLICATION_VOIP && application_ != OPUS_APPLICATION_AUDIO &&
+        application_ != OPUS_APPLICATION_RESTRICTED_LOWDELAY)
+    {
+      Napi::RangeError::New(info.Env(), "application must be 'audio', 'voip' or 'lowdelay'").ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
   outPcm_ = new opus_int16[channels_ * MAX_FRAME_SIZE]();
   outOpus_ = new unsigned char[MAX_PACKET_SIZE]();
 }
@@ -97,6 +70,12 @@ OpusEncoderWrap::~OpusEncoderWrap()
     opus_encoder_destroy(enc_);
   if (dec_)
     opus_decoder_destroy(dec_);
+  if (analyzer_)
+    frame_analyzer_destroy(analyzer_);
+  if (dred_)
+    opus_dred_free(dred_);
+  if (dredDec_)
+    opus_dred_decoder_destroy(dredDec_);
   delete[] outPcm_;
   delete[] outOpus_;
 }
@@ -126,58 +105,387 @@ int OpusEncoderWrap::EnsureDecoder()
   return err;
 }
 
+// Both return OPUS_UNIMPLEMENTED unless libopus was built with opus_dnn=1.
+int OpusEncoderWrap::EnsureDred()
+{
+  if (dred_)
+    return OPUS_OK;
+  int err;
+  if (!dredDec_)
+  {
+    dredDec_ = opus_dred_decoder_create(&err);
+    if (err != OPUS_OK)
+    {
+      dredDec_ = nullptr;
+      return err;
+    }
+  }
+  OpusDRED *tmp = opus_dred_alloc(&err);
+  if (err == OPUS_OK)
+    dred_ = tmp;
+  return err;
+}
+
+bool OpusEncoderWrap::CheckIdle(Napi::Env env)
+{
+  if (asyncPending_ == 0)
+    return true;
+  Napi::Error::New(env, "Encoder has pending async work").ThrowAsJavaScriptException();
+  return false;
+}
+
+OpusEncoderWrap *OpusEncoderWrap::FromValue(Napi::Env env, Napi::Value value)
+{
+  AddonData *data = env.GetInstanceData<AddonData>();
+  if (!data || !value.IsObject() || !value.As<Napi::Object>().InstanceOf(data->encoderCtor.Value()))
+    return nullptr;
+  return OpusEncoderWrap::Unwrap(value.As<Napi::Object>());
+}
+
 // -----------------------------------------------------------------------------
-// Encode PCM -> Opus packet (returns Buffer)
+// Native encode / decode (shared by the sync methods and async paths)
 // -----------------------------------------------------------------------------
-Napi::Value OpusEncoderWrap::Encode(const Napi::CallbackInfo &info)
+int OpusEncoderWrap::EncodeInto(const opus_int16 *pcm, int frameSize, unsigned char *out, opus_int32 maxBytes)
+{
+  int rc = EnsureEncoder();
+  if (rc != OPUS_OK)
+    return rc;
+  return EncodeFrame(pcm, frameSize, out, maxBytes);
+}
+
+int OpusEncoderWrap::DecodeInto(const unsigned char *data, opus_int32 len, opus_int16 *pcm, int maxFrameSize)
+{
+  int rc = EnsureDecoder();
+  if (rc != OPUS_OK)
+    return rc;
+  return opus_decode(dec_, data, len, pcm, maxFrameSize, 0);
+}
+
+// -----------------------------------------------------------------------------
+// Silence gate
+// -----------------------------------------------------------------------------
+
+// True if every sample satisfies |x| <= threshold. Works on blocks of 64 with
+// branch‑free OR reductions so the compiler can vectorize the inner loop.
+static bool IsSilent(const opus_int16 *pcm, size_t n, int threshold)
+{
+  const int hi = threshold, lo = -threshold;
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    int loud = 0;
+    for (size_t j = 0; j < 64; ++j)
+      loud |= (pcm[i + j] > hi) | (pcm[i + j] < lo);
+    if (loud)
+      return false;
+  }
+  int loud = 0;
+  for (; i < n; ++i)
+    loud |= (pcm[i] > hi) | (pcm[i] < lo);
+  return !loud;
+}
+
+int OpusEncoderWrap::EncodeFrame(const opus_int16 *pcm, int frameSize, unsigned char *out, opus_int32 maxBytes)
+{
+  SilenceGate &g = silence_;
+  if (g.enabled)
+  {
+    if (IsSilent(pcm, static_cast<size_t>(frameSize) * channels_, g.threshold))
+    {
+      ++g.silent;
+      // The hangover frames go through the encoder, so its history is already
+      // silence when we stop feeding it and speech onset starts clean.
+      if (++g.run > g.hangover && g.tocFrameSize == frameSize)
+      {
+        int bypassed = g.run - g.hangover;
+        if (g.skip)
+        {
+          ++g.bypassed;
+          return 0;
+        }
+        // The TOC's config only covers one 2.5–20 ms frame; longer packets
+        // (CELT > 20 ms, anything > 60 ms) need a frame count to keep the
+        // receiver's timeline.
+        const int frames = frameSize / opus_packet_get_samples_per_frame(&g.toc, rate_);
+        if (bypassed % g.refresh != 0 && maxBytes >= 2)
+        {
+          ++g.bypassed;
+          if (frames == 1)
+          {
+            out[0] = g.toc & 0xfc; // code 0: one frame, zero payload => DTX/CNG
+            return 1;
+          }
+          out[0] = (g.toc & 0xfc) | 3;               // code 3: frame count follows
+          out[1] = static_cast<unsigned char>(frames); // CBR, no padding, all empty
+          return 2;
+        }
+      }
+    }
+    else
+    {
+      g.run = 0;
+    }
+  }
+
+  if (!governor_ || !governor_->Enabled())
+    return EncodeTracked(pcm, frameSize, out, maxBytes);
+
+  // Follow the governor's targets, never above the caller's own settings,
+  // then report how long this frame took.
+  const int complexity = std::min(governor_->Complexity(), userComplexity_);
+  if (complexity != appliedComplexity_)
+  {
+    appliedComplexity_ = complexity;
+    opus_encoder_ctl(enc_, OPUS_SET_COMPLEXITY(appliedComplexity_));
+  }
+  const int bandwidth =
+      governor_->AdaptsBandwidth() ? std::min(governor_->MaxBandwidth(), userMaxBandwidth_) : userMaxBandwidth_;
+  if (bandwidth != appliedBandwidth_)
+  {
+    appliedBandwidth_ = bandwidth;
+    opus_encoder_ctl(enc_, OPUS_SET_MAX_BANDWIDTH(appliedBandwidth_));
+  }
+  auto start = std::chrono::steady_clock::now();
+  int clen = EncodeTracked(pcm, frameSize, out, maxBytes);
+  governor_->Record(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  return clen;
+}
+
+void OpusEncoderWrap::WrapperSettings(opus_int32 out[kWrapperSettings]) const
+{
+  const bool governed = governor_ && governor_->Enabled();
+  out[0] = silence_.enabled;
+  out[1] = silence_.enabled && silence_.skip;
+  out[2] = silence_.enabled ? silence_.threshold : 0;
+  out[3] = silence_.enabled ? silence_.hangover : 0;
+  out[4] = silence_.enabled ? silence_.refresh : 0;
+  out[5] = governed;
+  out[6] = governed && governor_ == &ComplexityGovernor::Global();
+}
+
+// opus_encode plus the bookkeeping the silence gate needs.
+int OpusEncoderWrap::EncodeTracked(const opus_int16 *pcm, int frameSize, unsigned char *out, opus_int32 maxBytes)
+{
+  SilenceGate &g = silence_;
+  int clen = opus_encode(enc_, pcm, frameSize, out, maxBytes);
+  if (clen > 0)
+  {
+    g.toc = out[0];
+    g.tocFrameSize = frameSize;
+  }
+  return clen;
+}
+
+// -----------------------------------------------------------------------------
+// Argument helper: validates info[0] as one PCM frame and creates the encoder.
+// Returns nullptr (with a pending JS exception) on failure.
+// -----------------------------------------------------------------------------
+const opus_int16 *OpusEncoderWrap::PcmArg(const Napi::CallbackInfo &info, int *frameSize)
 {
   Napi::Env env = info.Env();
-  if (info.Length() < 1 || !info[0].IsBuffer())
+  ByteView view;
+  if (info.Length() < 1 || !GetByteView(env, info[0], &view))
   {
-    Napi::TypeError::New(env, "Argument must be a Buffer containing 16‑bit PCM").ThrowAsJavaScriptException();
-    return env.Null();
+    Napi::TypeError::New(env, "Argument must be a Buffer, TypedArray, DataView or ArrayBuffer containing 16‑bit PCM")
+        .ThrowAsJavaScriptException();
+    return nullptr;
   }
 
   if (EnsureEncoder() != OPUS_OK)
   {
     Napi::Error::New(env, "Failed to create libopus encoder (bad params?)").ThrowAsJavaScriptException();
-    return env.Null();
+    return nullptr;
   }
 
-  Napi::Buffer<char> buf = info[0].As<Napi::Buffer<char>>();
-  if (buf.Length() % (2 * channels_) != 0)
+  if (view.length % (2 * channels_) != 0)
   {
     Napi::RangeError::New(env, "PCM buffer length must be multiple of (channels*2 bytes)").ThrowAsJavaScriptException();
-    return env.Null();
+    return nullptr;
   }
 
-  const opus_int16 *pcm = reinterpret_cast<const opus_int16 *>(buf.Data());
-  int frameSize = buf.Length() / 2 / channels_;
-  if (frameSize > MAX_FRAME_SIZE)
+  *frameSize = view.length / 2 / channels_;
+  if (*frameSize == 0)
+  {
+    Napi::RangeError::New(env, "PCM buffer is empty").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  if (*frameSize > MAX_FRAME_SIZE)
   {
     Napi::RangeError::New(env, "Frame exceeds MAX_FRAME_SIZE").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  return AlignedPcm(view, &inPcm_);
+}
+
+// -----------------------------------------------------------------------------
+// Encode PCM -> Opus packet (returns Buffer)
+// -----------------------------------------------------------------------------
+Napi::Value OpusEncoderWrap::Encode(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
+  int frameSize;
+  const opus_int16 *pcm = PcmArg(info, &frameSize);
+  if (!pcm)
+    return env.Null();
+
+  int clen = EncodeFrame(pcm, frameSize, outOpus_, MAX_PACKET_SIZE);
+  if (clen < 0)
+  {
+    Napi::Error::New(env, StrError(clen)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Buffer<char>::Copy(env, reinterpret_cast<char *>(outOpus_), clen);
+}
+
+// -----------------------------------------------------------------------------
+// encodeWithInfo(pcm, info: Int32Array) -> Buffer
+// Fills info[0..kInfoSlots) with per‑frame metadata in the same call.
+// -----------------------------------------------------------------------------
+Napi::Value OpusEncoderWrap::EncodeWithInfo(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
+  if (info.Length() < 2 || !info[1].IsTypedArray() || info[1].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array ||
+      info[1].As<Napi::Int32Array>().ElementLength() < kInfoSlots)
+  {
+    Napi::TypeError::New(env, "Expected (pcm: Buffer, info: Int32Array of at least 8 elements)").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  int clen = opus_encode(enc_, pcm, frameSize, outOpus_, MAX_PACKET_SIZE);
+  int frameSize;
+  const opus_int16 *pcm = PcmArg(info, &frameSize);
+  if (!pcm)
+    return env.Null();
+
+  uint64_t bypassedBefore = silence_.bypassed;
+  int clen = EncodeFrame(pcm, frameSize, outOpus_, MAX_PACKET_SIZE);
   if (clen < 0)
   {
     Napi::Error::New(env, StrError(clen)).ThrowAsJavaScriptException();
     return env.Null();
   }
+  bool bypassed = silence_.bypassed != bypassedBefore;
+
+  opus_uint32 range = 0;
+  opus_int32 lookahead = 0, inDtx = 0;
+  if (!bypassed)
+  {
+    opus_encoder_ctl(enc_, OPUS_GET_FINAL_RANGE(&range));
+    opus_encoder_ctl(enc_, OPUS_GET_IN_DTX(&inDtx));
+  }
+  opus_encoder_ctl(enc_, OPUS_GET_LOOKAHEAD(&lookahead));
+
+  int32_t *out = info[1].As<Napi::Int32Array>().Data();
+  if (clen > 0)
+  {
+    int config = outOpus_[0] >> 3;
+    out[kInfoMode] = config < 12 ? 0 : config < 16 ? 1 : 2;
+    out[kInfoBandwidth] = opus_packet_get_bandwidth(outOpus_);
+  }
+  else
+  {
+    out[kInfoMode] = -1;
+    out[kInfoBandwidth] = 0;
+  }
+  out[kInfoFinalRange] = static_cast<int32_t>(range);
+  out[kInfoBytes] = clen;
+  out[kInfoDtx] = bypassed || inDtx || clen <= 1;
+  out[kInfoLookahead] = lookahead;
+  out[kInfoFrameSize] = frameSize;
+  out[kInfoBitrate] = static_cast<int32_t>(static_cast<int64_t>(clen) * 8 * rate_ / frameSize);
 
   return Napi::Buffer<char>::Copy(env, reinterpret_cast<char *>(outOpus_), clen);
 }
 
+// -----------------------------------------------------------------------------
+// Speech / music analysis
+// -----------------------------------------------------------------------------
+bool OpusEncoderWrap::RunAnalysis(Napi::Env env, const opus_int16 *pcm, int frameSize, FrameAnalysis *out)
+{
+  if (!analyzer_)
+    analyzer_ = frame_analyzer_create(rate_, channels_);
+  if (!analyzer_)
+  {
+    Napi::RangeError::New(env, "Analysis needs a 16, 24 or 48 kHz mono/stereo encoder").ThrowAsJavaScriptException();
+    return false;
+  }
+  frame_analyzer_run(analyzer_, pcm, frameSize, out);
+  return true;
+}
+
+static Napi::Object AnalysisToObject(Napi::Env env, const FrameAnalysis &a)
+{
+  Napi::Object o = Napi::Object::New(env);
+  o.Set("valid", Napi::Boolean::New(env, a.valid != 0));
+  o.Set("vad", Napi::Number::New(env, a.vad));
+  o.Set("music", Napi::Number::New(env, a.music));
+  o.Set("activity", Napi::Number::New(env, a.activity));
+  o.Set("tonality", Napi::Number::New(env, a.tonality));
+  o.Set("noisiness", Napi::Number::New(env, a.noisiness));
+  o.Set("bandwidth", Napi::Number::New(env, a.bandwidth));
+  return o;
+}
+
+// encodeWithAnalysis(pcm) -> { packet, analysis }
+Napi::Value OpusEncoderWrap::EncodeWithAnalysis(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
+  int frameSize;
+  const opus_int16 *pcm = PcmArg(info, &frameSize);
+  FrameAnalysis analysis;
+  if (!pcm || !RunAnalysis(env, pcm, frameSize, &analysis))
+    return env.Null();
+
+  int clen = EncodeFrame(pcm, frameSize, outOpus_, MAX_PACKET_SIZE);
+  if (clen < 0)
+  {
+    Napi::Error::New(env, StrError(clen)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("packet", Napi::Buffer<char>::Copy(env, reinterpret_cast<char *>(outOpus_), clen));
+  result.Set("analysis", AnalysisToObject(env, analysis));
+  return result;
+}
+
+// analyze(pcm) -> analysis, without running the encoder at all
+Napi::Value OpusEncoderWrap::Analyze(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
+  int frameSize;
+  const opus_int16 *pcm = PcmArg(info, &frameSize);
+  FrameAnalysis analysis;
+  if (!pcm || !RunAnalysis(env, pcm, frameSize, &analysis))
+    return env.Null();
+  return AnalysisToObject(env, analysis);
+}
+
 // -----------------------------------------------------------------------------
 // Decode Opus packet -> PCM buffer
 // -----------------------------------------------------------------------------
 Napi::Value OpusEncoderWrap::Decode(const Napi::CallbackInfo &info)
 {
   Napi::Env env = info.Env();
-  if (info.Length() < 1 || !info[0].IsBuffer())
+  if (!CheckIdle(env))
+    return env.Null();
+
+  ByteView view;
+  if (info.Length() < 1 || !GetByteView(env, info[0], &view))
   {
-    Napi::TypeError::New(env, "Argument must be a Buffer").ThrowAsJavaScriptException();
+    Napi::TypeError::New(env, "Argument must be a Buffer, TypedArray, DataView or ArrayBuffer").ThrowAsJavaScriptException();
     return env.Null();
   }
 
@@ -187,8 +495,7 @@ Napi::Value OpusEncoderWrap::Decode(const Napi::CallbackInfo &info)
     return env.Null();
   }
 
-  Napi::Buffer<unsigned char> buf = info[0].As<Napi::Buffer<unsigned char>>();
-  int dlen = opus_decode(dec_, buf.Data(), buf.Length(), outPcm_, MAX_FRAME_SIZE, 0);
+  int dlen = opus_decode(dec_, view.data, static_cast<opus_int32>(view.length), outPcm_, MAX_FRAME_SIZE, 0);
   if (dlen < 0)
   {
     Napi::Error::New(env, StrError(dlen)).ThrowAsJavaScriptException();
@@ -205,6 +512,9 @@ Napi::Value OpusEncoderWrap::Decode(const Napi::CallbackInfo &info)
 Napi::Value OpusEncoderWrap::ApplyEncoderCTL(const Napi::CallbackInfo &info)
 {
   Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
   if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber())
   {
     Napi::TypeError::New(env, "Expected (ctl: number, value: number)").ThrowAsJavaScriptException();
@@ -225,12 +535,28 @@ Napi::Value OpusEncoderWrap::ApplyEncoderCTL(const Napi::CallbackInfo &info)
     Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
     return env.Null();
   }
+  if (ctl == OPUS_SET_BANDWIDTH_REQUEST)
+    forcedBandwidth_ = value;
+  if (governor_ && ctl == OPUS_SET_COMPLEXITY_REQUEST)
+  {
+    // Governed: remember it for detach, but the governor stays in charge.
+    userComplexity_ = value;
+    appliedComplexity_ = -1;
+  }
+  if (governor_ && ctl == OPUS_SET_MAX_BANDWIDTH_REQUEST)
+  {
+    userMaxBandwidth_ = value;
+    appliedBandwidth_ = -1;
+  }
   return Napi::Number::New(env, rc);
 }
 
 Napi::Value OpusEncoderWrap::ApplyDecoderCTL(const Napi::CallbackInfo &info)
 {
   Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
   if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber())
   {
     Napi::TypeError::New(env, "Expected (ctl: number, value: number)").ThrowAsJavaScriptException();
@@ -260,6 +586,9 @@ Napi::Value OpusEncoderWrap::ApplyDecoderCTL(const Napi::CallbackInfo &info)
 Napi::Value OpusEncoderWrap::SetBitrate(const Napi::CallbackInfo &info)
 {
   Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
   if (info.Length() < 1 || !info[0].IsNumber())
   {
     Napi::TypeError::New(env, "Expected bitrate (number)").ThrowAsJavaScriptException();
@@ -285,6 +614,9 @@ Napi::Value OpusEncoderWrap::SetBitrate(const Napi::CallbackInfo &info)
 Napi::Value OpusEncoderWrap::GetBitrate(const Napi::CallbackInfo &info)
 {
   Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
   if (EnsureEncoder() != OPUS_OK)
   {
     Napi::Error::New(env, "Encoder not initialised").ThrowAsJavaScriptException();
@@ -301,6 +633,320 @@ Napi::Value OpusEncoderWrap::GetBitrate(const Napi::CallbackInfo &info)
   return Napi::Number::New(env, br);
 }
 
+// -----------------------------------------------------------------------------
+// setSilenceDetection(options | false) / getSilenceStats()
+// -----------------------------------------------------------------------------
+Napi::Value OpusEncoderWrap::SetSilenceDetection(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
+  if (info.Length() < 1 || (!info[0].IsObject() && !info[0].IsBoolean()))
+  {
+    Napi::TypeError::New(env, "Expected (options: object | boolean)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  SilenceGate g;
+  g.enabled = info[0].IsObject() || info[0].ToBoolean().Value();
+  Napi::Value dtx = env.Undefined();
+  if (info[0].IsObject())
+  {
+    Napi::Object o = info[0].As<Napi::Object>();
+    if (o.Get("threshold").IsNumber())
+      g.threshold = o.Get("threshold").ToNumber().Int32Value();
+    if (o.Get("hangoverFrames").IsNumber())
+      g.hangover = o.Get("hangoverFrames").ToNumber().Int32Value();
+    if (o.Get("refreshFrames").IsNumber())
+      g.refresh = o.Get("refreshFrames").ToNumber().Int32Value();
+    if (o.Get("mode").IsString())
+    {
+      std::string mode = o.Get("mode").ToString().Utf8Value();
+      if (mode != "dtx" && mode != "skip")
+      {
+        Napi::RangeError::New(env, "mode must be 'dtx' or 'skip'").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      g.skip = mode == "skip";
+    }
+    dtx = o.Get("dtx");
+  }
+  if (g.threshold < 0 || g.threshold > 32767 || g.hangover < 0 || g.refresh < 1)
+  {
+    Napi::RangeError::New(env, "Invalid threshold, hangoverFrames or refreshFrames").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Let libopus' own DTX handle the frames around the bypassed run as well.
+  // Without the option, OPUS_SET_DTX stays whatever the caller set.
+  if (!dtx.IsUndefined())
+  {
+    if (EnsureEncoder() != OPUS_OK)
+    {
+      Napi::Error::New(env, "Encoder not initialised").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    int rc = opus_encoder_ctl(enc_, OPUS_SET_DTX(dtx.ToBoolean().Value() ? 1 : 0));
+    if (rc != OPUS_OK)
+    {
+      Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  g.toc = silence_.toc;
+  g.tocFrameSize = silence_.tocFrameSize;
+  silence_ = g;
+  return env.Undefined();
+}
+
+Napi::Value OpusEncoderWrap::GetSilenceStats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("silentFrames", Napi::Number::New(env, static_cast<double>(silence_.silent)));
+  stats.Set("bypassedFrames", Napi::Number::New(env, static_cast<double>(silence_.bypassed)));
+  stats.Set("inSilence", Napi::Boolean::New(env, silence_.enabled && silence_.run > silence_.hangover));
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Encode time budget
+// setTimeBudget(options | 'global' | false), OpusEncoder.setGlobalTimeBudget()
+// -----------------------------------------------------------------------------
+static bool ParseBudget(Napi::Env env, Napi::Value value, ComplexityGovernor::Config *config)
+{
+  Napi::Object o = value.As<Napi::Object>();
+  if (!o.Get("budgetUs").IsNumber())
+  {
+    Napi::TypeError::New(env, "options.budgetUs must be a number").ThrowAsJavaScriptException();
+    return false;
+  }
+  config->budgetUs = o.Get("budgetUs").ToNumber().DoubleValue();
+  if (o.Get("minComplexity").IsNumber())
+    config->minComplexity = o.Get("minComplexity").ToNumber().Int32Value();
+  if (o.Get("maxComplexity").IsNumber())
+    config->maxComplexity = o.Get("maxComplexity").ToNumber().Int32Value();
+  if (o.Get("windowFrames").IsNumber())
+    config->windowFrames = o.Get("windowFrames").ToNumber().Int32Value();
+  config->adaptBandwidth = o.Get("adaptBandwidth").ToBoolean().Value();
+  if (config->budgetUs <= 0 || config->minComplexity < 0 || config->maxComplexity > 10 ||
+      config->minComplexity > config->maxComplexity || config->windowFrames < 1)
+  {
+    Napi::RangeError::New(env, "Invalid budgetUs, complexity range or windowFrames").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
+}
+
+Napi::Value OpusEncoderWrap::SetTimeBudget(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
+  bool detach = info.Length() > 0 && (info[0].IsNull() || (info[0].IsBoolean() && !info[0].ToBoolean().Value()));
+  if (info.Length() < 1 || !(detach || info[0].IsObject() || info[0].IsString()))
+  {
+    Napi::TypeError::New(env, "Expected (options: object | 'global' | false)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info[0].IsString() && info[0].ToString().Utf8Value() != "global")
+  {
+    Napi::RangeError::New(env, "Expected 'global'").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  ComplexityGovernor::Config config;
+  if (info[0].IsObject() && !ParseBudget(env, info[0], &config))
+    return env.Null();
+  if (EnsureEncoder() != OPUS_OK)
+  {
+    Napi::Error::New(env, "Encoder not initialised").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (detach)
+  {
+    // Undo what the governor lowered: back to the caller's own settings.
+    if (governor_)
+    {
+      opus_encoder_ctl(enc_, OPUS_SET_COMPLEXITY(userComplexity_));
+      opus_encoder_ctl(enc_, OPUS_SET_MAX_BANDWIDTH(userMaxBandwidth_));
+    }
+    governor_ = nullptr;
+    ownGovernor_.reset();
+    return env.Undefined();
+  }
+
+  if (!governor_)
+  {
+    opus_encoder_ctl(enc_, OPUS_GET_COMPLEXITY(&userComplexity_));
+    opus_encoder_ctl(enc_, OPUS_GET_MAX_BANDWIDTH(&userMaxBandwidth_));
+  }
+  if (info[0].IsString())
+  {
+    governor_ = &ComplexityGovernor::Global();
+    ownGovernor_.reset();
+  }
+  else
+  {
+    if (!ownGovernor_)
+      ownGovernor_.reset(new ComplexityGovernor());
+    ownGovernor_->Configure(config);
+    governor_ = ownGovernor_.get();
+  }
+  appliedComplexity_ = appliedBandwidth_ = -1;
+  return env.Undefined();
+}
+
+Napi::Value OpusEncoderWrap::SetGlobalTimeBudget(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  ComplexityGovernor::Config config; // budgetUs 0 disables
+  if (info.Length() < 1 || !(info[0].IsObject() || (info[0].IsBoolean() && !info[0].ToBoolean().Value())))
+  {
+    Napi::TypeError::New(env, "Expected (options: object | false)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info[0].IsObject() && !ParseBudget(env, info[0], &config))
+    return env.Null();
+  ComplexityGovernor::Global().Configure(config);
+  return env.Undefined();
+}
+
+Napi::Value OpusEncoderWrap::GetTimeBudgetStats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!governor_)
+    return env.Null();
+  ComplexityGovernor::Stats s = governor_->GetStats();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("complexity", Napi::Number::New(env, s.complexity));
+  stats.Set("maxBandwidth", Napi::Number::New(env, s.maxBandwidth));
+  stats.Set("p99Us", Napi::Number::New(env, s.p99Us));
+  stats.Set("frames", Napi::Number::New(env, static_cast<double>(s.frames)));
+  stats.Set("adjustments", Napi::Number::New(env, static_cast<double>(s.adjustments)));
+  stats.Set("global", Napi::Boolean::New(env, governor_ == &ComplexityGovernor::Global()));
+  return stats;
+}
+
+// Encoder lookahead in samples at the input rate; algorithmic delay is this
+// plus the frame size (2.5 ms + frame with 'lowdelay', 6.5 ms + frame otherwise).
+Napi::Value OpusEncoderWrap::GetLookahead(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+  if (EnsureEncoder() != OPUS_OK)
+  {
+    Napi::Error::New(env, "Encoder not initialised").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  opus_int32 lookahead = 0;
+  opus_encoder_ctl(enc_, OPUS_GET_LOOKAHEAD(&lookahead));
+  return Napi::Number::New(env, lookahead);
+}
+
+// -----------------------------------------------------------------------------
+// Deep REDundancy (libopus 1.5 DNN build)
+// -----------------------------------------------------------------------------
+static const char *kNoDnn = "DRED needs a build with opus_dnn=1";
+
+// setDredDuration(frames) – DRED history to embed in every packet, in 10 ms
+// units (0..104). Only spent when OPUS_SET_PACKET_LOSS_PERC is non‑zero.
+Napi::Value OpusEncoderWrap::SetDredDuration(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+  if (info.Length() < 1 || !info[0].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (frames: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (EnsureEncoder() != OPUS_OK)
+  {
+    Napi::Error::New(env, "Encoder not initialised").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int rc = opus_encoder_ctl(enc_, OPUS_SET_DRED_DURATION(info[0].ToNumber().Int32Value()));
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, rc == OPUS_UNIMPLEMENTED ? kNoDnn : StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return env.Undefined();
+}
+
+// decodeDred(packet, lostFrames, frameSize) -> { pcm, recovered }
+// Rebuilds the `lostFrames` frames lost just before `packet` from the DRED
+// data it carries, oldest first; frames beyond its horizon are concealed with
+// PLC. `packet` itself is not decoded – pass it to decode() next.
+Napi::Value OpusEncoderWrap::DecodeDred(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckIdle(env))
+    return env.Null();
+
+  ByteView view;
+  if (info.Length() < 3 || !GetByteView(env, info[0], &view) || !info[1].IsNumber() || !info[2].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (packet: Buffer, lostFrames: number, frameSize: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  const int lost = info[1].ToNumber().Int32Value();
+  const int frameSize = info[2].ToNumber().Int32Value();
+  if (lost < 1 || frameSize < 1 || frameSize > MAX_FRAME_SIZE || static_cast<int64_t>(lost) * frameSize > rate_)
+  {
+    Napi::RangeError::New(env, "lostFrames * frameSize must cover between 1 sample and 1 s").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int rc = EnsureDecoder();
+  if (rc == OPUS_OK)
+    rc = EnsureDred();
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, rc == OPUS_UNIMPLEMENTED ? kNoDnn : StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // `available`: how far back, in samples, the packet's DRED reaches. A
+  // malformed DRED extension is treated like none at all.
+  int dredEnd = 0;
+  int available = opus_dred_parse(dredDec_, dred_, view.data, static_cast<opus_int32>(view.length), lost * frameSize, rate_,
+                                  &dredEnd, 0);
+  if (available < 0)
+    available = 0;
+
+  const size_t frameBytes = static_cast<size_t>(frameSize) * channels_ * sizeof(opus_int16);
+  Napi::Buffer<char> pcm = Napi::Buffer<char>::New(env, frameBytes * lost);
+  int recovered = 0;
+  for (int i = 0; i < lost; ++i)
+  {
+    opus_int16 *out = reinterpret_cast<opus_int16 *>(pcm.Data() + frameBytes * i);
+    const int offset = (lost - i) * frameSize;
+    int n;
+    if (offset <= available)
+    {
+      n = opus_decoder_dred_decode(dec_, dred_, offset, out, frameSize);
+      recovered += n > 0;
+    }
+    else
+      n = opus_decode(dec_, nullptr, 0, out, frameSize, 0);
+    if (n < 0)
+    {
+      Napi::Error::New(env, StrError(n)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("pcm", pcm);
+  result.Set("recovered", Napi::Number::New(env, recovered));
+  return result;
+}
+
 // -----------------------------------------------------------------------------
 // JS class registration
 // -----------------------------------------------------------------------------
@@ -308,13 +954,42 @@ Napi::Object OpusEncoderWrap::Init(Napi::Env env, Napi::Object exports)
 {
   Napi::Function ctor = Napi::ObjectWrap<OpusEncoderWrap>::DefineClass(env, "OpusEncoder", {
                                                                                                InstanceMethod("encode", &OpusEncoderWrap::Encode),
+                                                                                               InstanceMethod("encodeWithAnalysis", &OpusEncoderWrap::EncodeWithAnalysis),
+                                                                                               InstanceMethod("analyze", &OpusEncoderWrap::Analyze),
+                                                                                               InstanceMethod("encodeWithInfo", &OpusEncoderWrap::EncodeWithInfo),
                                                                                                InstanceMethod("decode", &OpusEncoderWrap::Decode),
                                                                                                InstanceMethod("applyEncoderCTL", &OpusEncoderWrap::ApplyEncoderCTL),
                                                                                                InstanceMethod("applyDecoderCTL", &OpusEncoderWrap::ApplyDecoderCTL),
                                                                                                InstanceMethod("setBitrate", &OpusEncoderWrap::SetBitrate),
                                                                                                InstanceMethod("getBitrate", &OpusEncoderWrap::GetBitrate),
+                                                                                               InstanceMethod("setSilenceDetection", &OpusEncoderWrap::SetSilenceDetection),
+                                                                                               InstanceMethod("getSilenceStats", &OpusEncoderWrap::GetSilenceStats),
+                                                                                               InstanceMethod("setTimeBudget", &OpusEncoderWrap::SetTimeBudget),
+                                                                                               InstanceMethod("getTimeBudgetStats", &OpusEncoderWrap::GetTimeBudgetStats),
+                                                                                               InstanceMethod("setDredDuration", &OpusEncoderWrap::SetDredDuration),
+                                                                                               InstanceMethod("decodeDred", &OpusEncoderWrap::DecodeDred),
+                                                                                               InstanceAccessor("lookahead", &OpusEncoderWrap::GetLookahead, nullptr),
+                                                                                               StaticMethod("setGlobalTimeBudget", &OpusEncoderWrap::SetGlobalTimeBudget),
                                                                                            });
   exports.Set("OpusEncoder", ctor);
+  exports.Set("dnn", Napi::Boolean::New(env,
+#ifdef ENABLE_DRED
+                                        true
+#else
+                                        false
+#endif
+                                        ));
+  exports.Set("fixedPoint", Napi::Boolean::New(env,
+#ifdef FIXED_POINT
+                                               true
+#else
+                                               false
+#endif
+                                               ));
+
+  AddonData *data = new AddonData();
+  data->encoderCtor = Napi::Persistent(ctor);
+  env.SetInstanceData<AddonData>(data);
   return exports;
 }
 
@@ -323,7 +998,23 @@ Napi::Object OpusEncoderWrap::Init(Napi::Env env, Napi::Object exports)
 // -----------------------------------------------------------------------------
 Napi::Object InitAll(Napi::Env env, Napi::Object exports)
 {
-  return OpusEncoderWrap::Init(env, exports);
+  OpusEncoderWrap::Init(env, exports);
+  LadderEncoderWrap::Init(env, exports);
+  InitFileCodec(env, exports);
+  InitOggEdit(env, exports);
+  OggSeekIndexWrap::Init(env, exports);
+  EncoderFarmWrap::Init(env, exports);
+  CodecPoolWrap::Init(env, exports);
+  PcmRingWrap::Init(env, exports);
+  RingEncoderWrap::Init(env, exports);
+  ClipCacheWrap::Init(env, exports);
+  RateControllerWrap::Init(env, exports);
+  RtpPacketizerWrap::Init(env, exports);
+  UdpTransportWrap::Init(env, exports);
+  PcmIngestWrap::Init(env, exports);
+  OggRecorderWrap::Init(env, exports);
+  OpusCustomEncoderWrap::Init(env, exports);
+  return exports;
 }
 
 // instead of NODE_API_MODULE(opus, InitAll)
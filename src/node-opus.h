@@ -1,7 +1,33 @@
 #pragma once
 
 #include <napi.h>
-#include "../libopus/opus/include/opus.h"
+#include <memory>
+#include <vector>
+#include "opus-common.h"
+#include "opus-analysis.h"
+#include "complexity-governor.h"
+
+// Per‑environment addon data (main thread and each worker_thread).
+struct AddonData
+{
+  Napi::FunctionReference encoderCtor; // OpusEncoder, for instanceof checks
+};
+
+// Slots written by encodeWithInfo(); mirrored by FrameInfo in index.ts.
+enum FrameInfoSlot
+{
+  kInfoMode = 0,       // 0 SILK, 1 hybrid, 2 CELT, -1 no packet
+  kInfoBandwidth,      // OPUS_BANDWIDTH_* of the packet, or 0
+  kInfoFinalRange,     // OPUS_GET_FINAL_RANGE (uint32 bit pattern)
+  kInfoBytes,          // packet length
+  kInfoDtx,            // 1 if this is a DTX / bypassed silence frame
+  kInfoLookahead,      // OPUS_GET_LOOKAHEAD, samples at the input rate
+  kInfoFrameSize,      // samples per channel
+  kInfoBitrate,        // bits per second actually spent on this frame
+  kInfoSlots
+};
+
+class CodecPoolWrap;
 
 class OpusEncoderWrap : public Napi::ObjectWrap<OpusEncoderWrap>
 {
@@ -11,27 +37,103 @@ public:
   OpusEncoderWrap(const Napi::CallbackInfo &info);
   ~OpusEncoderWrap();
 
-  // JS-exposed methods
+  // Returns the wrapped instance if `value` is an OpusEncoder, else nullptr.
+  static OpusEncoderWrap *FromValue(Napi::Env env, Napi::Value value);
+
+  // Native entry points for work running off the JS thread. The caller must
+  // guarantee exclusive access (see asyncPending_).
+  int EncodeInto(const opus_int16 *pcm, int frameSize, unsigned char *out, opus_int32 maxBytes);
+  int DecodeInto(const unsigned char *data, opus_int32 len, opus_int16 *pcm, int maxFrameSize);
+  int Channels() const { return channels_; }
+  opus_int32 Rate() const { return rate_; }
+  // Last OPUS_SET_BANDWIDTH passed to applyEncoderCTL (OPUS_AUTO if none);
+  // libopus only reports the bandwidth of the last frame.
+  int ForcedBandwidth() const { return forcedBandwidth_; }
+  // The wrapper's own settings that change what encode() emits (silence gate,
+  // time budget), packed for cache keys.
+  static constexpr int kWrapperSettings = 7;
+  void WrapperSettings(opus_int32 out[kWrapperSettings]) const;
+
+  // The underlying libopus state (created on demand), or nullptr on failure.
+  // Encoding through it bypasses the silence gate.
+  ::OpusEncoder *RawEncoder() { return EnsureEncoder() == OPUS_OK ? enc_ : nullptr; }
+
+  // Async jobs queued on this instance; the sync methods refuse to run while
+  // this is non‑zero. Only touched on the JS thread.
+  int asyncPending_{0};
+  // The pool those jobs are on. A pool only serialises its own jobs, so a
+  // second pool must not take the encoder until the first is done with it.
+  CodecPoolWrap *asyncOwner_{nullptr};
+
+private:
+  // JS‑exposed methods
   Napi::Value Encode(const Napi::CallbackInfo &info);
+  Napi::Value EncodeWithAnalysis(const Napi::CallbackInfo &info);
+  Napi::Value Analyze(const Napi::CallbackInfo &info);
+  Napi::Value EncodeWithInfo(const Napi::CallbackInfo &info);
   Napi::Value Decode(const Napi::CallbackInfo &info);
   Napi::Value ApplyEncoderCTL(const Napi::CallbackInfo &info);
   Napi::Value ApplyDecoderCTL(const Napi::CallbackInfo &info);
   Napi::Value SetBitrate(const Napi::CallbackInfo &info);
   Napi::Value GetBitrate(const Napi::CallbackInfo &info);
+  Napi::Value SetSilenceDetection(const Napi::CallbackInfo &info);
+  Napi::Value GetSilenceStats(const Napi::CallbackInfo &info);
+  Napi::Value SetTimeBudget(const Napi::CallbackInfo &info);
+  Napi::Value GetTimeBudgetStats(const Napi::CallbackInfo &info);
+  static Napi::Value SetGlobalTimeBudget(const Napi::CallbackInfo &info);
+  Napi::Value GetLookahead(const Napi::CallbackInfo &info);
+  Napi::Value SetDredDuration(const Napi::CallbackInfo &info);
+  Napi::Value DecodeDred(const Napi::CallbackInfo &info);
 
-private:
   // Helpers
   int EnsureEncoder();
   int EnsureDecoder();
+  int EnsureDred();
+  bool CheckIdle(Napi::Env env);
+  int EncodeFrame(const opus_int16 *pcm, int frameSize, unsigned char *out, opus_int32 maxBytes);
+  int EncodeTracked(const opus_int16 *pcm, int frameSize, unsigned char *out, opus_int32 maxBytes);
+  const opus_int16 *PcmArg(const Napi::CallbackInfo &info, int *frameSize);
+  bool RunAnalysis(Napi::Env env, const opus_int16 *pcm, int frameSize, FrameAnalysis *out);
+
+  // Silence gate in front of opus_encode: after `hangover` silent frames the
+  // encoder is bypassed and a TOC‑only (DTX) packet, or nothing, is emitted.
+  struct SilenceGate
+  {
+    bool enabled{false};
+    bool skip{false};      // emit nothing instead of a 1‑byte DTX packet
+    int threshold{0};      // peak |sample| still counted as silence
+    int hangover{10};      // silent frames encoded normally before bypassing
+    int refresh{20};       // real frame every N bypassed frames (DTX mode)
+    int run{0};            // consecutive silent frames
+    unsigned char toc{0};  // TOC of the last real packet
+    int tocFrameSize{0};   // frame size that TOC describes
+    uint64_t silent{0};
+    uint64_t bypassed{0};
+  };
+  SilenceGate silence_;
+
+  // Encode time budget: governor_ is ownGovernor_ or the global one.
+  ComplexityGovernor *governor_{nullptr};
+  std::unique_ptr<ComplexityGovernor> ownGovernor_;
+  int appliedComplexity_{-1};
+  int appliedBandwidth_{-1};
+  // The caller's own settings, put back when the governor is detached.
+  int userComplexity_{-1};
+  int userMaxBandwidth_{-1};
 
-  // Members (must match the .cpp)
+  // Members
   opus_int32 rate_{0};
   int channels_{0};
   int application_{OPUS_APPLICATION_AUDIO};
+  int forcedBandwidth_{OPUS_AUTO};
 
   ::OpusEncoder *enc_{nullptr};
   ::OpusDecoder *dec_{nullptr};
+  FrameAnalyzer *analyzer_{nullptr}; // created by the first analysed frame
+  OpusDREDDecoder *dredDec_{nullptr}; // created by the first decodeDred()
+  OpusDRED *dred_{nullptr};
 
+  std::vector<opus_int16> inPcm_;   // aligned copy of odd‑offset input views
   opus_int16 *outPcm_{nullptr};     // channels_ * MAX_FRAME_SIZE
   unsigned char *outOpus_{nullptr}; // MAX_PACKET_SIZE
 };
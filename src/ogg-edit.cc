@@ -0,0 +1,354 @@
+// ogg-edit.cc – cut and concatenate Ogg Opus without touching the codec.
+
+#include "ogg-edit.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include "byte-view.h"
+#include "mapped-file.h"
+#include "ogg-opus.h"
+#include "opus-common.h"
+
+static constexpr double kDefaultPreRollMs = 80.0; // RFC 7845 §4.6
+
+// -----------------------------------------------------------------------------
+// Cutting and joining
+// -----------------------------------------------------------------------------
+
+// One parsed part: its packets, the decoded position (48 kHz, pre‑skip
+// included) where each one starts, and the kept range [from, to) in the same
+// units. exactFrom/exactTo say whether the caller asked for that edge rather
+// than taking the stream's own start or end.
+struct CutSource
+{
+  OggOpusReader reader;
+  std::vector<int64_t> pos;
+  int64_t from{0};
+  int64_t to{0};
+  bool exactFrom{false};
+  bool exactTo{false};
+};
+
+static bool OpenCutSource(const OggCutPart &part, CutSource *src, std::string *error)
+{
+  OggOpusReader &reader = src->reader;
+  if (!reader.Open(part.data, part.length))
+  {
+    *error = reader.Error();
+    return false;
+  }
+  const OpusHeadInfo &head = reader.Head();
+  if (head.mappingFamily != 0)
+  {
+    *error = "Only mono/stereo (mapping family 0) streams can be edited";
+    return false;
+  }
+
+  const std::vector<OggOpusPacket> &packets = reader.Packets();
+  src->pos.assign(packets.size() + 1, 0);
+  for (size_t i = 0; i < packets.size(); ++i)
+  {
+    int ns = packets[i].len ? opus_packet_get_nb_samples(packets[i].data, static_cast<opus_int32>(packets[i].len), 48000) : 0;
+    if (ns < 0)
+    {
+      *error = StrError(ns);
+      return false;
+    }
+    src->pos[i + 1] = src->pos[i] + ns;
+  }
+  int64_t total = std::max<int64_t>(0, src->pos.back() - head.preSkip);
+  if (reader.EndGranule() >= 0)
+    total = std::max<int64_t>(0, std::min(total, reader.EndGranule() - reader.StartGranule() - head.preSkip));
+
+  const int64_t start = std::min(std::max<int64_t>(part.range.start, 0), total);
+  const int64_t end = part.range.end < 0 ? total : std::min(std::max(part.range.end, start), total);
+  if (end <= start)
+  {
+    *error = "Cut range is empty";
+    return false;
+  }
+  src->from = start + head.preSkip;
+  src->to = end + head.preSkip;
+  src->exactFrom = part.range.start >= 0;
+  src->exactTo = part.range.end >= 0 && part.range.end < total;
+  return true;
+}
+
+// Index of the first packet boundary at or after `at`, clamped to the last.
+static size_t BoundaryAtOrAfter(const std::vector<int64_t> &pos, int64_t at)
+{
+  return std::min(static_cast<size_t>(std::lower_bound(pos.begin(), pos.end(), at) - pos.begin()), pos.size() - 1);
+}
+
+// Index of the last packet boundary at or before `at`.
+static size_t BoundaryAtOrBefore(const std::vector<int64_t> &pos, int64_t at)
+{
+  size_t i = static_cast<size_t>(std::upper_bound(pos.begin(), pos.end(), at) - pos.begin());
+  return i ? i - 1 : 0;
+}
+
+// Inner joins carry decoder state from the previous part, so they can only
+// sit on packet boundaries; say where the nearest ones are.
+static std::string InnerCutError(const char *edge, const CutSource &src, int64_t at)
+{
+  const std::vector<int64_t> &pos = src.pos;
+  const int64_t preSkip = src.reader.Head().preSkip;
+  auto ms = [&](size_t i) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.2f", static_cast<double>(pos[i] - preSkip) / 48.0);
+    return std::string(buf);
+  };
+  return std::string(edge) + " of an inner join must fall on a packet boundary (nearest " +
+         ms(BoundaryAtOrBefore(pos, at)) + " or " + ms(BoundaryAtOrAfter(pos, at)) + " ms)";
+}
+
+bool WriteOggCuts(const std::vector<OggCutPart> &parts, int64_t preRoll, uint32_t serial, std::vector<unsigned char> *out,
+                  std::string *error, size_t *failedPart)
+{
+  std::vector<CutSource> sources(parts.size());
+  for (size_t p = 0; p < parts.size(); ++p)
+  {
+    *failedPart = p;
+    if (!OpenCutSource(parts[p], &sources[p], error))
+      return false;
+    const OpusHeadInfo &head = sources[p].reader.Head();
+    const OpusHeadInfo &head0 = sources[0].reader.Head();
+    if (head.channels != head0.channels || head.outputGain != head0.outputGain)
+    {
+      *error = "Channel count and output gain must match the first part";
+      return false;
+    }
+  }
+
+  OggOpusWriter *writer = nullptr;
+  std::unique_ptr<OggOpusWriter> owner;
+  int64_t base = 0; // output granule where the current part starts
+  for (size_t p = 0; p < sources.size(); ++p)
+  {
+    *failedPart = p;
+    const CutSource &src = sources[p];
+    const std::vector<int64_t> &pos = src.pos;
+    const bool lastPart = p + 1 == sources.size();
+
+    // The first part starts at the packet holding the pre‑roll point and its
+    // pre‑skip discards the pre‑roll; the last part's end granule trims it to
+    // the exact sample. Every other edge is an inner join: the next part is
+    // decoded with the previous one's decoder state and there is no pre‑skip
+    // to trim with, so a join must sit on a packet boundary. A later part
+    // without startMs starts at its first boundary past its own pre‑skip, so
+    // the encoder's priming samples are never played at the join.
+    size_t first;
+    if (p == 0)
+    {
+      const int64_t rollFrom = std::max<int64_t>(0, src.from - preRoll);
+      first = BoundaryAtOrBefore(pos, rollFrom);
+    }
+    else
+    {
+      if (src.exactFrom && !std::binary_search(pos.begin(), pos.end(), src.from))
+      {
+        *error = InnerCutError("startMs", src, src.from);
+        return false;
+      }
+      first = BoundaryAtOrAfter(pos, src.from);
+    }
+    size_t last;
+    if (lastPart)
+    {
+      last = BoundaryAtOrAfter(pos, src.to);
+    }
+    else
+    {
+      if (src.exactTo && !std::binary_search(pos.begin(), pos.end(), src.to))
+      {
+        *error = InnerCutError("endMs", src, src.to);
+        return false;
+      }
+      last = BoundaryAtOrBefore(pos, src.to);
+    }
+    if (last <= first || first + 1 >= pos.size())
+    {
+      *error = "Cut range holds no whole packet";
+      return false;
+    }
+
+    if (p == 0)
+    {
+      const int64_t preSkip = src.from - pos[first];
+      if (preSkip > 0xffff)
+      {
+        *error = "Pre-roll does not fit in the OpusHead pre-skip field";
+        return false;
+      }
+      const OpusHeadInfo &head = src.reader.Head();
+      owner.reset(new OggOpusWriter(serial, head.channels, head.inputRate, static_cast<uint16_t>(preSkip)));
+      writer = owner.get();
+      writer->SetOutputGain(head.outputGain);
+      writer->WriteHeaders();
+    }
+
+    const std::vector<OggOpusPacket> &packets = src.reader.Packets();
+    for (size_t i = first; i < last; ++i)
+    {
+      bool eos = lastPart && i + 1 == last;
+      int64_t granule = base + (eos ? std::max(src.to, pos[first]) : pos[i + 1]) - pos[first];
+      writer->WritePacket(packets[i].data, packets[i].len, granule, eos);
+    }
+    base += pos[last] - pos[first];
+  }
+  std::vector<unsigned char> data = writer->TakeData();
+  out->insert(out->end(), data.begin(), data.end());
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// JS entry points
+// -----------------------------------------------------------------------------
+
+// A Buffer/view is used in place; a string is memory‑mapped.
+struct EditSource
+{
+  const unsigned char *data{nullptr};
+  size_t length{0};
+  std::unique_ptr<MappedFile> file;
+};
+
+static bool GetSource(Napi::Env env, Napi::Value value, EditSource *source)
+{
+  if (value.IsString())
+  {
+    source->file.reset(new MappedFile);
+    if (!source->file->Open(value.ToString().Utf8Value()))
+    {
+      Napi::Error::New(env, source->file->Error()).ThrowAsJavaScriptException();
+      return false;
+    }
+    source->data = source->file->Data();
+    source->length = source->file->Size();
+    return true;
+  }
+  ByteView view;
+  if (!GetByteView(env, value, &view))
+  {
+    Napi::TypeError::New(env, "Expected an Ogg Opus Buffer or a path").ThrowAsJavaScriptException();
+    return false;
+  }
+  source->data = view.data;
+  source->length = view.length;
+  return true;
+}
+
+static bool GetEditOptions(Napi::Env env, Napi::Value value, int64_t *preRoll, uint32_t *serial)
+{
+  double preRollMs = kDefaultPreRollMs;
+  *serial = std::random_device()();
+  if (value.IsObject())
+  {
+    Napi::Object o = value.As<Napi::Object>();
+    if (o.Get("preRollMs").IsNumber())
+      preRollMs = o.Get("preRollMs").ToNumber().DoubleValue();
+    if (o.Get("serial").IsNumber())
+      *serial = o.Get("serial").ToNumber().Uint32Value();
+  }
+  if (!(preRollMs >= 0) || preRollMs > 1000)
+  {
+    Napi::RangeError::New(env, "preRollMs must be between 0 and 1000").ThrowAsJavaScriptException();
+    return false;
+  }
+  *preRoll = static_cast<int64_t>(preRollMs * 48.0);
+  return true;
+}
+
+static int64_t MsToSamples(double ms)
+{
+  return static_cast<int64_t>(ms * 48.0 + 0.5);
+}
+
+Napi::Value CutOggOpus(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[1].IsNumber() || (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNumber()))
+  {
+    Napi::TypeError::New(env, "Expected (source: Buffer | string, startMs: number, endMs?: number, options?: object)")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  EditSource source;
+  if (!GetSource(env, info[0], &source))
+    return env.Null();
+  int64_t preRoll;
+  uint32_t serial;
+  if (!GetEditOptions(env, info.Length() > 3 ? info[3] : env.Undefined(), &preRoll, &serial))
+    return env.Null();
+
+  OggCutPart part;
+  part.data = source.data;
+  part.length = source.length;
+  part.range.start = MsToSamples(info[1].ToNumber().DoubleValue());
+  if (info.Length() > 2 && info[2].IsNumber())
+    part.range.end = MsToSamples(info[2].ToNumber().DoubleValue());
+
+  std::vector<unsigned char> out;
+  std::string error;
+  size_t failed;
+  if (!WriteOggCuts({part}, preRoll, serial, &out, &error, &failed))
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(out.data()), out.size());
+}
+
+// parts: (Buffer | string | { source, startMs?, endMs? })[]
+Napi::Value ConcatOggOpus(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsArray() || info[0].As<Napi::Array>().Length() == 0)
+  {
+    Napi::TypeError::New(env, "Expected (parts: non-empty array, options?: object)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int64_t preRoll;
+  uint32_t serial;
+  if (!GetEditOptions(env, info.Length() > 1 ? info[1] : env.Undefined(), &preRoll, &serial))
+    return env.Null();
+
+  Napi::Array array = info[0].As<Napi::Array>();
+  std::vector<EditSource> sources(array.Length());
+  std::vector<OggCutPart> parts(array.Length());
+  for (uint32_t i = 0; i < array.Length(); ++i)
+  {
+    Napi::Value part = array.Get(i);
+    Napi::Value src = part;
+    if (part.IsObject() && !part.IsBuffer() && !part.IsTypedArray() && !part.IsDataView() && !part.IsArrayBuffer())
+    {
+      Napi::Object o = part.As<Napi::Object>();
+      src = o.Get("source");
+      if (o.Get("startMs").IsNumber())
+        parts[i].range.start = MsToSamples(o.Get("startMs").ToNumber().DoubleValue());
+      if (o.Get("endMs").IsNumber())
+        parts[i].range.end = MsToSamples(o.Get("endMs").ToNumber().DoubleValue());
+    }
+    if (!GetSource(env, src, &sources[i]))
+      return env.Null();
+    parts[i].data = sources[i].data;
+    parts[i].length = sources[i].length;
+  }
+
+  std::vector<unsigned char> out;
+  std::string error;
+  size_t failed;
+  if (!WriteOggCuts(parts, preRoll, serial, &out, &error, &failed))
+  {
+    Napi::Error::New(env, "Part " + std::to_string(failed) + ": " + error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(out.data()), out.size());
+}
+
+void InitOggEdit(Napi::Env env, Napi::Object exports)
+{
+  exports.Set("cutOggOpus", Napi::Function::New(env, CutOggOpus, "cutOggOpus"));
+  exports.Set("concatOggOpus", Napi::Function::New(env, ConcatOggOpus, "concatOggOpus"));
+}
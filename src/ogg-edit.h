@@ -0,0 +1,43 @@
+#pragma once
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Compressed‑domain editing of Ogg Opus – no decode, no re‑encode.
+// Cuts keep whole packets: the decoder starts ~80 ms early and the new
+// pre‑skip and end granule trim to the exact sample. Concatenation writes one
+// logical stream with continuous granules, so every reader sees the whole
+// result. Inner joins are only packet‑accurate: a later part decodes with
+// the previous part's decoder state, so its start (and every part's end but
+// the last) must sit on one of its packet boundaries.
+// -----------------------------------------------------------------------------
+struct OggCutRange
+{
+  int64_t start{-1}; // 48 kHz samples of audio (after pre‑skip); -1 = from the start
+  int64_t end{-1};  // exclusive; -1 = to the end of the stream
+};
+
+struct OggCutPart
+{
+  const unsigned char *data{nullptr};
+  size_t length{0};
+  OggCutRange range;
+};
+
+// Appends one logical stream holding the parts' ranges, in order, to *out.
+// Parts must share channel count and output gain. On failure *failedPart is
+// the index of the offending part.
+bool WriteOggCuts(const std::vector<OggCutPart> &parts, int64_t preRoll, uint32_t serial, std::vector<unsigned char> *out,
+                  std::string *error, size_t *failedPart);
+
+// cutOggOpus(source, startMs, endMs?, options?) -> Buffer
+Napi::Value CutOggOpus(const Napi::CallbackInfo &info);
+
+// concatOggOpus(parts, options?) -> Buffer
+Napi::Value ConcatOggOpus(const Napi::CallbackInfo &info);
+
+void InitOggEdit(Napi::Env env, Napi::Object exports);
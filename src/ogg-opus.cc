@@ -0,0 +1,320 @@
+// ogg-opus.cc – Ogg page framing for Opus streams.
+
+#include "ogg-opus.h"
+#include <cstring>
+#include "opus-common.h"
+
+static constexpr size_t kMaxPageBody = 4096; // flush threshold, like opusenc
+static constexpr size_t kMaxSegments = 255;
+
+// -----------------------------------------------------------------------------
+// CRC
+// -----------------------------------------------------------------------------
+static const uint32_t *CrcTable()
+{
+  static const struct Table
+  {
+    uint32_t v[256];
+    Table()
+    {
+      for (uint32_t i = 0; i < 256; ++i)
+      {
+        uint32_t r = i << 24;
+        for (int j = 0; j < 8; ++j)
+          r = (r & 0x80000000u) ? (r << 1) ^ 0x04c11db7u : (r << 1);
+        v[i] = r;
+      }
+    }
+  } table;
+  return table.v;
+}
+
+uint32_t OggCrc(const unsigned char *data, size_t len, uint32_t crc)
+{
+  const uint32_t *t = CrcTable();
+  for (size_t i = 0; i < len; ++i)
+    crc = (crc << 8) ^ t[((crc >> 24) & 0xff) ^ data[i]];
+  return crc;
+}
+
+// -----------------------------------------------------------------------------
+// OggOpusWriter
+// -----------------------------------------------------------------------------
+OggOpusWriter::OggOpusWriter(uint32_t serial, int channels, uint32_t inputRate, uint16_t preSkip)
+    : serial_(serial), channels_(channels), inputRate_(inputRate), preSkip_(preSkip)
+{
+}
+
+void OggOpusWriter::WriteHeaders()
+{
+  // OpusHead, mapping family 0 (mono/stereo)
+  unsigned char head[19];
+  std::memcpy(head, "OpusHead", 8);
+  head[8] = 1; // version
+  head[9] = static_cast<unsigned char>(channels_);
+  PutLE16(head + 10, preSkip_);
+  PutLE32(head + 12, inputRate_);
+  PutLE16(head + 16, static_cast<uint16_t>(outputGain_));
+  head[18] = 0;          // channel mapping family
+  unsigned char lacing = sizeof(head);
+  WritePage(&lacing, 1, head, sizeof(head), 0, 0x02);
+
+  // OpusTags with the libopus vendor string and no user comments
+  const char *vendor = opus_get_version_string();
+  uint32_t vlen = static_cast<uint32_t>(std::strlen(vendor));
+  std::vector<unsigned char> tags(8 + 4 + vlen + 4);
+  std::memcpy(tags.data(), "OpusTags", 8);
+  PutLE32(tags.data() + 8, vlen);
+  std::memcpy(tags.data() + 12, vendor, vlen);
+  PutLE32(tags.data() + 12 + vlen, 0);
+  std::vector<unsigned char> seg(tags.size() / 255 + 1, 255);
+  seg.back() = tags.size() % 255;
+  WritePage(seg.data(), seg.size(), tags.data(), tags.size(), 0, 0);
+}
+
+void OggOpusWriter::WritePacket(const unsigned char *data, size_t len, int64_t granule, bool eos)
+{
+  size_t need = len / 255 + 1;
+  if (segments_.size() + need > kMaxSegments)
+    Flush();
+
+  for (size_t i = 0; i < len / 255; ++i)
+    segments_.push_back(255);
+  segments_.push_back(len % 255);
+  body_.insert(body_.end(), data, data + len);
+  granule_ = granule;
+
+  if (eos)
+  {
+    WritePage(segments_.data(), segments_.size(), body_.data(), body_.size(), granule_, 0x04);
+    segments_.clear();
+    body_.clear();
+  }
+  else if (body_.size() >= kMaxPageBody)
+  {
+    Flush();
+  }
+}
+
+void OggOpusWriter::Flush()
+{
+  if (segments_.empty())
+    return;
+  WritePage(segments_.data(), segments_.size(), body_.data(), body_.size(), granule_, 0);
+  segments_.clear();
+  body_.clear();
+}
+
+std::vector<unsigned char> OggOpusWriter::TakeData()
+{
+  std::vector<unsigned char> data;
+  data.swap(out_);
+  return data;
+}
+
+void OggOpusWriter::WritePage(const unsigned char *segments, size_t nsegments, const unsigned char *body, size_t bodyLen,
+                              int64_t granule, unsigned char flags)
+{
+  size_t start = out_.size();
+  out_.resize(start + 27 + nsegments + bodyLen);
+  unsigned char *p = out_.data() + start;
+
+  std::memcpy(p, "OggS", 4);
+  p[4] = 0; // version
+  p[5] = flags;
+  PutLE64(p + 6, static_cast<uint64_t>(granule));
+  PutLE32(p + 14, serial_);
+  PutLE32(p + 18, sequence_++);
+  PutLE32(p + 22, 0); // CRC, filled below
+  p[26] = static_cast<unsigned char>(nsegments);
+  std::memcpy(p + 27, segments, nsegments);
+  std::memcpy(p + 27 + nsegments, body, bodyLen);
+
+  PutLE32(p + 22, OggCrc(p, 27 + nsegments + bodyLen));
+}
+
+// -----------------------------------------------------------------------------
+// Page / header parsing
+// -----------------------------------------------------------------------------
+size_t ParseOggPage(const unsigned char *data, size_t len, OggPageInfo *page, bool checkCrc)
+{
+  if (len < 27 || std::memcmp(data, "OggS", 4) != 0 || data[4] != 0)
+    return 0;
+  size_t nseg = data[26];
+  if (len < 27 + nseg)
+    return 0;
+  size_t body = 0;
+  for (size_t i = 0; i < nseg; ++i)
+    body += data[27 + i];
+  size_t size = 27 + nseg + body;
+  if (len < size)
+    return 0;
+
+  if (checkCrc)
+  {
+    static const unsigned char zeros[4] = {0, 0, 0, 0};
+    uint32_t crc = OggCrc(data, 22);
+    crc = OggCrc(zeros, 4, crc);
+    crc = OggCrc(data + 26, size - 26, crc);
+    if (crc != GetLE32(data + 22))
+      return 0;
+  }
+
+  page->size = size;
+  page->flags = data[5];
+  page->granule = static_cast<int64_t>(GetLE64(data + 6));
+  page->serial = GetLE32(data + 14);
+  page->sequence = GetLE32(data + 18);
+  return size;
+}
+
+bool ParseOpusHead(const unsigned char *data, size_t len, OpusHeadInfo *head)
+{
+  if (len < 19 || std::memcmp(data, "OpusHead", 8) != 0 || (data[8] & 0xf0) != 0)
+    return false;
+  head->channels = data[9];
+  head->preSkip = GetLE16(data + 10);
+  head->inputRate = GetLE32(data + 12);
+  head->outputGain = static_cast<int16_t>(GetLE16(data + 16));
+  head->mappingFamily = data[18];
+  return head->channels > 0;
+}
+
+// -----------------------------------------------------------------------------
+// OggOpusReader
+// -----------------------------------------------------------------------------
+bool OggOpusReader::Open(const unsigned char *data, size_t len)
+{
+  error_.clear();
+  pages_.clear();
+  packets_.clear();
+  spill_.clear();
+  startGranule_ = 0;
+
+  bool haveSerial = false;
+  uint32_t serial = 0;
+  int headerPackets = 0;
+  std::vector<unsigned char> partial;
+  bool inPartial = false;
+
+  size_t pos = 0;
+  while (pos + 27 <= len)
+  {
+    OggPageInfo page;
+    size_t n = ParseOggPage(data + pos, len - pos, &page);
+    if (!n)
+    {
+      // Resync on the next capture pattern.
+      const unsigned char *next = static_cast<const unsigned char *>(std::memchr(data + pos + 1, 'O', len - pos - 1));
+      while (next && (static_cast<size_t>(next - data) + 4 > len || std::memcmp(next, "OggS", 4) != 0))
+        next = static_cast<const unsigned char *>(std::memchr(next + 1, 'O', len - (next + 1 - data)));
+      if (!next)
+        break;
+      pos = next - data;
+      continue;
+    }
+    page.offset = pos;
+
+    if (!haveSerial)
+    {
+      if (!(page.flags & 0x02))
+      {
+        pos += n;
+        continue;
+      }
+      serial = page.serial;
+      haveSerial = true;
+    }
+    if (page.serial != serial)
+    {
+      pos += n;
+      continue;
+    }
+
+    const bool audioPage = headerPackets >= 2;
+    if (!(page.flags & 0x01))
+    {
+      partial.clear();
+      inPartial = false;
+    }
+
+    const unsigned char *seg = data + pos + 27;
+    const size_t nseg = data[pos + 26];
+    const unsigned char *body = seg + nseg;
+    size_t start = 0, off = 0;
+    for (size_t i = 0; i < nseg; ++i)
+    {
+      off += seg[i];
+      if (seg[i] == 255)
+        continue;
+
+      const unsigned char *pkt = body + start;
+      size_t plen = off - start;
+      if (inPartial)
+      {
+        partial.insert(partial.end(), pkt, pkt + plen);
+        spill_.push_back(std::move(partial));
+        partial = std::vector<unsigned char>();
+        inPartial = false;
+        pkt = spill_.back().data();
+        plen = spill_.back().size();
+      }
+      start = off;
+
+      if (headerPackets == 0)
+      {
+        if (!ParseOpusHead(pkt, plen, &head_))
+        {
+          error_ = "Stream does not start with a valid OpusHead";
+          return false;
+        }
+        ++headerPackets;
+      }
+      else if (headerPackets == 1)
+      {
+        ++headerPackets; // OpusTags, not needed
+      }
+      else
+      {
+        packets_.push_back({pkt, plen});
+      }
+    }
+    if (start < off)
+    {
+      partial.insert(partial.end(), body + start, body + off);
+      inPartial = true;
+    }
+
+    if (audioPage)
+    {
+      page.packetEnd = packets_.size();
+      pages_.push_back(page);
+    }
+    pos += n;
+    if (page.flags & 0x04)
+      break;
+  }
+
+  if (headerPackets < 2)
+  {
+    error_ = "No Ogg Opus stream found";
+    return false;
+  }
+
+  // The first audio page's granule minus its own samples gives the start
+  // position (non‑zero for streams cut out of a longer recording).
+  if (!pages_.empty() && pages_.front().granule >= 0)
+  {
+    int64_t samples = 0;
+    for (size_t i = 0; i < pages_.front().packetEnd; ++i)
+    {
+      int ns = packets_[i].len ? opus_packet_get_nb_samples(packets_[i].data, packets_[i].len, 48000) : 0;
+      if (ns > 0)
+        samples += ns;
+    }
+    startGranule_ = pages_.front().granule - samples;
+    if (startGranule_ < 0)
+      startGranule_ = 0;
+  }
+  return true;
+}
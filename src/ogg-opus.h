@@ -0,0 +1,157 @@
+#pragma once
+
+// Minimal Ogg encapsulation for Opus (RFC 3533 / RFC 7845).
+// Only what the addon needs: single‑stream, mapping family 0, packets that
+// never span pages (Opus packets are at most a few KB).
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Little‑endian field access (Ogg and Opus headers are LE on every platform).
+inline uint16_t GetLE16(const unsigned char *p)
+{
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t GetLE32(const unsigned char *p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t GetLE64(const unsigned char *p)
+{
+  return static_cast<uint64_t>(GetLE32(p)) | (static_cast<uint64_t>(GetLE32(p + 4)) << 32);
+}
+
+inline void PutLE16(unsigned char *p, uint16_t v)
+{
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+}
+
+inline void PutLE32(unsigned char *p, uint32_t v)
+{
+  for (int i = 0; i < 4; ++i)
+    p[i] = (v >> (8 * i)) & 0xff;
+}
+
+inline void PutLE64(unsigned char *p, uint64_t v)
+{
+  for (int i = 0; i < 8; ++i)
+    p[i] = (v >> (8 * i)) & 0xff;
+}
+
+// Ogg page CRC (poly 0x04c11db7, no reflection, init 0).
+uint32_t OggCrc(const unsigned char *data, size_t len, uint32_t crc = 0);
+
+// -----------------------------------------------------------------------------
+// OggOpusWriter – packets in, complete Ogg pages out (appended to a vector)
+// -----------------------------------------------------------------------------
+class OggOpusWriter
+{
+public:
+  // preSkip is in 48 kHz samples; inputRate is informational (OpusHead).
+  OggOpusWriter(uint32_t serial, int channels, uint32_t inputRate, uint16_t preSkip);
+
+  // Q7.8 dB gain stored in OpusHead; set before WriteHeaders().
+  void SetOutputGain(int16_t gain) { outputGain_ = gain; }
+
+  // Emits the OpusHead and OpusTags pages. Call once before any packet.
+  void WriteHeaders();
+
+  // Queues one Opus packet ending at 48 kHz granule position `granule`.
+  // Pages are flushed automatically; `eos` flushes and marks the last page.
+  void WritePacket(const unsigned char *data, size_t len, int64_t granule, bool eos = false);
+
+  // Forces the pending packets out as a page (no‑op if nothing is queued).
+  void Flush();
+
+  // Encoded bytes so far; TakeData() hands them over and clears the buffer.
+  const std::vector<unsigned char> &Data() const { return out_; }
+  std::vector<unsigned char> TakeData();
+
+  uint32_t PageCount() const { return sequence_; }
+
+private:
+  void WritePage(const unsigned char *segments, size_t nsegments, const unsigned char *body, size_t bodyLen,
+                 int64_t granule, unsigned char flags);
+
+  uint32_t serial_;
+  int channels_;
+  uint32_t inputRate_;
+  uint16_t preSkip_;
+  int16_t outputGain_{0};
+  uint32_t sequence_{0};
+
+  std::vector<unsigned char> segments_; // lacing values of the pending page
+  std::vector<unsigned char> body_;     // payload of the pending page
+  int64_t granule_{0};                  // granule of the last queued packet
+  std::vector<unsigned char> out_;
+};
+
+// -----------------------------------------------------------------------------
+// Reading
+// -----------------------------------------------------------------------------
+struct OggPageInfo
+{
+  size_t offset{0};   // byte offset of "OggS" in the file/buffer
+  size_t size{0};     // header + segment table + body
+  int64_t granule{-1};
+  uint32_t serial{0};
+  uint32_t sequence{0};
+  unsigned char flags{0}; // 0x01 continued, 0x02 BOS, 0x04 EOS
+  size_t packetEnd{0};    // audio packets completed up to and including this page
+};
+
+// Parses the page header at data[0..len). Returns the page size, or 0 if the
+// bytes are not a complete page (or the CRC does not match when checked).
+size_t ParseOggPage(const unsigned char *data, size_t len, OggPageInfo *page, bool checkCrc = true);
+
+struct OpusHeadInfo
+{
+  int channels{0};
+  uint16_t preSkip{0};
+  uint32_t inputRate{0};
+  int16_t outputGain{0};
+  int mappingFamily{0};
+};
+
+bool ParseOpusHead(const unsigned char *data, size_t len, OpusHeadInfo *head);
+
+struct OggOpusPacket
+{
+  const unsigned char *data;
+  size_t len;
+};
+
+// -----------------------------------------------------------------------------
+// OggOpusReader – splits an in‑memory Ogg Opus file into its audio packets.
+// Follows the first logical stream; packets point into the caller's buffer
+// unless they span pages, in which case they are reassembled internally.
+// -----------------------------------------------------------------------------
+class OggOpusReader
+{
+public:
+  bool Open(const unsigned char *data, size_t len);
+
+  const std::string &Error() const { return error_; }
+  const OpusHeadInfo &Head() const { return head_; }
+  const std::vector<OggPageInfo> &Pages() const { return pages_; } // audio pages only
+  const std::vector<OggOpusPacket> &Packets() const { return packets_; }
+
+  // 48 kHz sample position of the first audio sample (normally 0).
+  int64_t StartGranule() const { return startGranule_; }
+  // Granule of the last audio page (end trimming), or -1 if unknown.
+  int64_t EndGranule() const { return pages_.empty() ? -1 : pages_.back().granule; }
+
+private:
+  std::string error_;
+  OpusHeadInfo head_;
+  std::vector<OggPageInfo> pages_;
+  std::vector<OggOpusPacket> packets_;
+  std::vector<std::vector<unsigned char>> spill_; // packets that spanned pages
+  int64_t startGranule_{0};
+};
@@ -0,0 +1,595 @@
+// ogg-recorder.cc – multi‑stream Ogg Opus recorder with batched disk writes.
+
+#include "ogg-recorder.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include "byte-view.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+static constexpr size_t kMaxIov = 1024;       // IOV_MAX on Linux and macOS
+static constexpr uint16_t kDefaultPreSkip = 312; // libopus lookahead at 48 kHz
+
+#ifndef _WIN32
+
+// pwritev() every chunk at *offset, resuming after short writes.
+static bool WriteChunks(int fd, const std::vector<std::vector<unsigned char>> &chunks, uint64_t *offset,
+                        std::atomic<uint64_t> *calls)
+{
+  std::vector<iovec> iov;
+  iov.reserve(chunks.size());
+  for (const std::vector<unsigned char> &c : chunks)
+    if (!c.empty())
+      iov.push_back({const_cast<unsigned char *>(c.data()), c.size()});
+
+  size_t i = 0;
+  while (i < iov.size())
+  {
+    int count = static_cast<int>(std::min(iov.size() - i, kMaxIov));
+    ssize_t n = ::pwritev(fd, &iov[i], count, static_cast<off_t>(*offset));
+    ++*calls;
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    *offset += static_cast<uint64_t>(n);
+    size_t left = static_cast<size_t>(n);
+    while (i < iov.size() && left >= iov[i].iov_len)
+      left -= iov[i++].iov_len;
+    if (left)
+    {
+      iov[i].iov_base = static_cast<unsigned char *>(iov[i].iov_base) + left;
+      iov[i].iov_len -= left;
+    }
+  }
+  return true;
+}
+
+static int SyncData(int fd)
+{
+#ifdef __APPLE__
+  return ::fsync(fd);
+#else
+  return ::fdatasync(fd);
+#endif
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// new OggRecorder({ flushIntervalMs = 1000, fsyncIntervalMs = 0,
+//                   fsyncOnClose = true, highWaterBytes = 1 MiB })
+// -----------------------------------------------------------------------------
+OggRecorderWrap::OggRecorderWrap(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<OggRecorderWrap>(info), core_(std::make_shared<Core>())
+{
+  Napi::Env env = info.Env();
+  closed_ = true; // until the I/O thread is running
+#ifndef _WIN32
+  double flushMs = 1000, fsyncMs = 0, highWater = static_cast<double>(core_->highWater);
+  if (info.Length() > 0 && info[0].IsObject())
+  {
+    Napi::Object o = info[0].As<Napi::Object>();
+    if (o.Get("flushIntervalMs").IsNumber())
+      flushMs = o.Get("flushIntervalMs").ToNumber().DoubleValue();
+    if (o.Get("fsyncIntervalMs").IsNumber())
+      fsyncMs = o.Get("fsyncIntervalMs").ToNumber().DoubleValue();
+    if (o.Get("fsyncOnClose").IsBoolean())
+      core_->fsyncOnClose = o.Get("fsyncOnClose").ToBoolean().Value();
+    if (o.Get("highWaterBytes").IsNumber())
+      highWater = o.Get("highWaterBytes").ToNumber().DoubleValue();
+  }
+  if (!(flushMs >= 1) || !(fsyncMs >= 0) || !(highWater >= 1))
+  {
+    Napi::RangeError::New(env, "flushIntervalMs must be >= 1, fsyncIntervalMs >= 0 and highWaterBytes >= 1")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  core_->flushInterval = std::chrono::milliseconds(static_cast<int64_t>(flushMs));
+  core_->fsyncInterval = std::chrono::milliseconds(static_cast<int64_t>(fsyncMs));
+  core_->highWater = static_cast<size_t>(highWater);
+  core_->owner = this;
+
+  core_->tsfn = Napi::ThreadSafeFunction::New(env, Napi::Function(), "OggRecorder", 0, 1);
+  core_->tsfn.Unref(env); // only keep the loop alive while promises are pending
+  std::shared_ptr<Core> core = core_;
+  std::thread([core] { core->Loop(core); }).detach();
+  closed_ = false;
+#else
+  Napi::Error::New(env, "OggRecorder is only available on POSIX systems").ThrowAsJavaScriptException();
+#endif
+}
+
+// Only reached once no stream is open and no promise is pending (see
+// UpdatePin), or at environment teardown. Anything still queued is finished
+// by the I/O thread, which exits afterwards.
+OggRecorderWrap::~OggRecorderWrap()
+{
+  core_->owner = nullptr;
+  if (closed_)
+    return;
+  {
+    std::lock_guard<std::mutex> lk(core_->mu);
+    core_->EndStreams();
+    core_->stop = true;
+  }
+  core_->wake.notify_one();
+}
+
+// Queues the EOS page of every recording still open.
+void OggRecorderWrap::Core::EndStreams()
+{
+  for (auto &kv : streams)
+  {
+    Stream &s = *kv.second;
+    if (s.closing)
+      continue;
+    if (s.haveHeld)
+      s.writer.WritePacket(s.held.data(), s.held.size(), s.granule, true);
+    s.chunks.push_back(s.writer.TakeData());
+    s.closing = true;
+  }
+}
+
+// Holds a reference to the JS object while it has open streams or pending
+// promises, so it cannot be collected with work in flight.
+void OggRecorderWrap::UpdatePin()
+{
+  bool pin = openStreams_ > 0 || !core_->waiters.empty();
+  if (pin == pinned_)
+    return;
+  pinned_ = pin;
+  if (pin)
+    Ref();
+  else
+    Unref();
+}
+
+// -----------------------------------------------------------------------------
+// I/O thread
+// -----------------------------------------------------------------------------
+void OggRecorderWrap::Kick()
+{
+  core_->wake.notify_one();
+}
+
+void OggRecorderWrap::Core::Loop(std::shared_ptr<Core> self)
+{
+  Clock::time_point nextSync = fsyncInterval.count() ? Clock::now() + fsyncInterval : Clock::time_point::max();
+  for (;;)
+  {
+    uint64_t round;
+    bool sync, stopping;
+    {
+      std::unique_lock<std::mutex> lk(mu);
+      wake.wait_until(lk, std::min(Clock::now() + flushInterval, nextSync),
+                      [this] { return stop || requested > done || queuedBytes >= highWater; });
+      round = requested;
+      sync = syncRequested;
+      syncRequested = false;
+      stopping = stop;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (now >= nextSync)
+    {
+      sync = true;
+      nextSync = now + fsyncInterval;
+    }
+    bool ok = WriteRound(sync);
+
+    bool settle;
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      settle = round > done;
+      done = std::max(done, round);
+    }
+    if (settle)
+      tsfn.NonBlockingCall(new Settled{round, ok}, [self](Napi::Env env, Napi::Function, Settled *s) { self->Settle(env, s); });
+    if (stopping)
+    {
+      tsfn.Release();
+      return;
+    }
+  }
+}
+
+bool OggRecorderWrap::Core::WriteRound(bool sync)
+{
+  struct Work
+  {
+    uint32_t id;
+    Stream *stream;
+    std::vector<std::vector<unsigned char>> chunks;
+    bool closing;
+  };
+  std::vector<Work> work;
+
+  // Take everything queued, including partial pages, under the lock; the
+  // writes themselves run without it so the JS thread never waits on disk.
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    for (auto &kv : streams)
+    {
+      Stream &s = *kv.second;
+      s.writer.Flush();
+      std::vector<unsigned char> page = s.writer.TakeData();
+      if (!page.empty())
+        s.chunks.push_back(std::move(page));
+      if (s.chunks.empty() && !s.closing && !(sync && s.dirty))
+        continue;
+      work.push_back({kv.first, &s, std::move(s.chunks), s.closing});
+      s.chunks.clear();
+    }
+    queuedBytes = 0;
+  }
+
+  bool ok = true;
+  std::string error;
+#ifndef _WIN32
+  for (Work &w : work)
+  {
+    Stream &s = *w.stream;
+    uint64_t before = s.offset;
+    if (!WriteChunks(s.fd, w.chunks, &s.offset, &writeCalls))
+    {
+      ok = false;
+      error = std::string("write failed: ") + std::strerror(errno);
+    }
+    bytesWritten += s.offset - before;
+    s.dirty = s.dirty || s.offset != before;
+
+    if (s.dirty && (sync || (w.closing && fsyncOnClose)))
+    {
+      if (SyncData(s.fd) != 0)
+      {
+        ok = false;
+        error = std::string("fsync failed: ") + std::strerror(errno);
+      }
+      ++fsyncs;
+      s.dirty = false;
+    }
+    if (w.closing)
+      ::close(s.fd);
+  }
+#endif
+
+  std::lock_guard<std::mutex> lk(mu);
+  for (const Work &w : work)
+    if (w.closing)
+      streams.erase(w.id);
+  if (!ok)
+  {
+    ++errors;
+    lastError = error;
+  }
+  return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Flush completion (JS thread)
+// -----------------------------------------------------------------------------
+void OggRecorderWrap::Core::Settle(Napi::Env env, Settled *settled)
+{
+  std::string error;
+  if (!settled->ok)
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    error = lastError;
+  }
+  auto it = waiters.begin();
+  for (; it != waiters.end() && it->first <= settled->round; ++it)
+  {
+    if (settled->ok)
+      it->second.Resolve(env.Undefined());
+    else
+      it->second.Reject(Napi::Error::New(env, error).Value());
+  }
+  waiters.erase(waiters.begin(), it);
+  if (waiters.empty())
+    tsfn.Unref(env);
+  if (owner)
+    owner->UpdatePin();
+  delete settled;
+}
+
+// Promise settled by the I/O thread once round `round` has finished.
+Napi::Value OggRecorderWrap::Wait(Napi::Env env, uint64_t round)
+{
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  core_->waiters.emplace_back(round, deferred);
+  if (core_->waiters.size() == 1)
+    core_->tsfn.Ref(env);
+  UpdatePin();
+  Kick();
+  return deferred.Promise();
+}
+
+// -----------------------------------------------------------------------------
+// open(path, { channels = 2, rate = 48000, preSkip = 312, serial }) -> stream id
+// -----------------------------------------------------------------------------
+Napi::Value OggRecorderWrap::Open(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Expected (path: string, options?: object)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (closed_)
+  {
+    Napi::Error::New(env, "OggRecorder is closed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int channels = 2;
+  uint32_t rate = 48000;
+  int preSkip = kDefaultPreSkip;
+  uint32_t serial = std::random_device()();
+  if (info.Length() > 1 && info[1].IsObject())
+  {
+    Napi::Object o = info[1].As<Napi::Object>();
+    if (o.Get("channels").IsNumber())
+      channels = o.Get("channels").ToNumber().Int32Value();
+    if (o.Get("rate").IsNumber())
+      rate = o.Get("rate").ToNumber().Uint32Value();
+    if (o.Get("preSkip").IsNumber())
+      preSkip = o.Get("preSkip").ToNumber().Int32Value();
+    if (o.Get("serial").IsNumber())
+      serial = o.Get("serial").ToNumber().Uint32Value();
+  }
+  if (channels < 1 || channels > 2 || preSkip < 0 || preSkip > 0xffff)
+  {
+    Napi::RangeError::New(env, "channels must be 1 or 2 and preSkip 0..65535").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+#ifndef _WIN32
+  std::string path = info[0].ToString().Utf8Value();
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+  {
+    Napi::Error::New(env, std::string("Failed to open ") + path + ": " + std::strerror(errno)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::unique_ptr<Stream> s(new Stream(serial, channels, rate, static_cast<uint16_t>(preSkip)));
+  s->fd = fd;
+  s->writer.WriteHeaders();
+  s->chunks.push_back(s->writer.TakeData());
+
+  uint32_t id = nextId_++;
+  {
+    std::lock_guard<std::mutex> lk(core_->mu);
+    core_->queuedBytes += s->chunks.back().size();
+    core_->streams[id] = std::move(s);
+  }
+  ++openStreams_;
+  UpdatePin();
+  return Napi::Number::New(env, id);
+#else
+  return env.Null();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Writing
+// Each packet is held back until the next one (or close) so the last page of
+// a recording can carry the EOS flag. Granules count 48 kHz samples.
+// -----------------------------------------------------------------------------
+bool OggRecorderWrap::Append(Napi::Env env, uint32_t id, const unsigned char *packet, size_t len)
+{
+  auto it = core_->streams.find(id);
+  if (it == core_->streams.end() || it->second->closing)
+  {
+    Napi::RangeError::New(env, "Unknown or closed recorder stream").ThrowAsJavaScriptException();
+    return false;
+  }
+  Stream &s = *it->second;
+  int samples = opus_packet_get_nb_samples(packet, static_cast<opus_int32>(len), 48000);
+  if (samples < 0)
+  {
+    Napi::Error::New(env, StrError(samples)).ThrowAsJavaScriptException();
+    return false;
+  }
+
+  if (s.haveHeld)
+    s.writer.WritePacket(s.held.data(), s.held.size(), s.granule);
+  s.held.assign(packet, packet + len);
+  s.haveHeld = true;
+  s.granule += samples;
+  ++core_->packets;
+
+  if (!s.writer.Data().empty())
+  {
+    s.chunks.push_back(s.writer.TakeData());
+    core_->queuedBytes += s.chunks.back().size();
+  }
+  return true;
+}
+
+// write(id, packet) -> undefined
+Napi::Value OggRecorderWrap::Write(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  ByteView packet;
+  if (info.Length() < 2 || !info[0].IsNumber() || !GetByteView(env, info[1], &packet) || packet.length == 0)
+  {
+    Napi::TypeError::New(env, "Expected (id: number, packet: Buffer | ArrayBufferView | ArrayBuffer)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  bool kick;
+  {
+    std::lock_guard<std::mutex> lk(core_->mu);
+    if (!Append(env, info[0].ToNumber().Uint32Value(), packet.data, packet.length))
+      return env.Null();
+    kick = core_->queuedBytes >= core_->highWater;
+  }
+  if (kick)
+    Kick();
+  return env.Undefined();
+}
+
+// writeBatch(slab, stride, lengths: Int32Array, ids: Int32Array) -> packets written
+// Same slab layout as EncoderFarm.tickAll; non‑positive lengths and negative
+// ids are skipped.
+Napi::Value OggRecorderWrap::WriteBatch(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  ByteView slab;
+  if (info.Length() < 4 || !GetByteView(env, info[0], &slab) || !info[1].IsNumber() || !info[2].IsTypedArray() ||
+      info[2].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array || !info[3].IsTypedArray() ||
+      info[3].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array)
+  {
+    Napi::TypeError::New(env, "Expected (slab: Buffer, stride: number, lengths: Int32Array, ids: Int32Array)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  size_t stride = info[1].ToNumber().Uint32Value();
+  Napi::Int32Array lengths = info[2].As<Napi::Int32Array>();
+  Napi::Int32Array ids = info[3].As<Napi::Int32Array>();
+  size_t n = std::min(lengths.ElementLength(), ids.ElementLength());
+  if (stride == 0 || slab.length < n * stride)
+  {
+    Napi::RangeError::New(env, "Slab must hold one stride per length").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint32_t written = 0;
+  bool kick;
+  {
+    std::lock_guard<std::mutex> lk(core_->mu);
+    for (size_t i = 0; i < n; ++i)
+    {
+      int32_t len = lengths[i];
+      if (len <= 0 || ids[i] < 0)
+        continue;
+      if (static_cast<size_t>(len) > stride)
+      {
+        Napi::RangeError::New(env, "Packet length exceeds stride").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      if (!Append(env, static_cast<uint32_t>(ids[i]), slab.data + i * stride, len))
+        return env.Null();
+      ++written;
+    }
+    kick = core_->queuedBytes >= core_->highWater;
+  }
+  if (kick)
+    Kick();
+  return Napi::Number::New(env, written);
+}
+
+// closeStream(id) – ends the recording; the file is closed by the next round.
+Napi::Value OggRecorderWrap::CloseStream(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (id: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  {
+    std::lock_guard<std::mutex> lk(core_->mu);
+    auto it = core_->streams.find(info[0].ToNumber().Uint32Value());
+    if (it == core_->streams.end() || it->second->closing)
+    {
+      Napi::RangeError::New(env, "Unknown or closed recorder stream").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Stream &s = *it->second;
+    if (s.haveHeld)
+      s.writer.WritePacket(s.held.data(), s.held.size(), s.granule, true);
+    s.chunks.push_back(s.writer.TakeData());
+    s.closing = true;
+  }
+  --openStreams_;
+  UpdatePin();
+  Kick();
+  return env.Undefined();
+}
+
+// flush(sync = false) -> Promise<void>, settled once everything written so far
+// is on disk (and synced, with `sync`).
+Napi::Value OggRecorderWrap::Flush(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (closed_)
+  {
+    Napi::Error::New(env, "OggRecorder is closed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  uint64_t round;
+  {
+    std::lock_guard<std::mutex> lk(core_->mu);
+    core_->syncRequested = core_->syncRequested || (info.Length() > 0 && info[0].ToBoolean().Value());
+    round = ++core_->requested;
+  }
+  return Wait(env, round);
+}
+
+Napi::Value OggRecorderWrap::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  Core &c = *core_;
+  std::lock_guard<std::mutex> lk(c.mu);
+  stats.Set("streams", Napi::Number::New(env, static_cast<double>(c.streams.size())));
+  stats.Set("queuedBytes", Napi::Number::New(env, static_cast<double>(c.queuedBytes)));
+  stats.Set("packets", Napi::Number::New(env, static_cast<double>(c.packets.load())));
+  stats.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(c.bytesWritten.load())));
+  stats.Set("writeCalls", Napi::Number::New(env, static_cast<double>(c.writeCalls.load())));
+  stats.Set("fsyncs", Napi::Number::New(env, static_cast<double>(c.fsyncs.load())));
+  stats.Set("errors", Napi::Number::New(env, static_cast<double>(c.errors.load())));
+  stats.Set("lastError", c.lastError.empty() ? env.Null() : Napi::String::New(env, c.lastError));
+  return stats;
+}
+
+// close() -> Promise<void> – ends every recording; settles once the I/O thread
+// has written (and, with fsyncOnClose, synced) them and stopped.
+Napi::Value OggRecorderWrap::Close(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (closed_)
+  {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+  closed_ = true;
+  uint64_t round;
+  {
+    std::lock_guard<std::mutex> lk(core_->mu);
+    core_->EndStreams();
+    core_->stop = true;
+    round = ++core_->requested;
+  }
+  openStreams_ = 0;
+  return Wait(env, round);
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object OggRecorderWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<OggRecorderWrap>::DefineClass(env, "OggRecorder", {
+                                                                                               InstanceMethod("open", &OggRecorderWrap::Open),
+                                                                                               InstanceMethod("write", &OggRecorderWrap::Write),
+                                                                                               InstanceMethod("writeBatch", &OggRecorderWrap::WriteBatch),
+                                                                                               InstanceMethod("closeStream", &OggRecorderWrap::CloseStream),
+                                                                                               InstanceMethod("flush", &OggRecorderWrap::Flush),
+                                                                                               InstanceMethod("stats", &OggRecorderWrap::Stats),
+                                                                                               InstanceMethod("close", &OggRecorderWrap::Close),
+                                                                                           });
+  exports.Set("OggRecorder", ctor);
+  return exports;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ogg-opus.h"
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// OggRecorder – many Ogg Opus recordings behind one JS object.
+// Packets are paged into per‑stream buffers on the JS thread; a dedicated I/O
+// thread writes whatever has accumulated every flush interval (or once a
+// high‑water mark is reached) with one pwritev() per stream, and fdatasync()s
+// dirty files on its own, slower schedule. POSIX only.
+// -----------------------------------------------------------------------------
+class OggRecorderWrap : public Napi::ObjectWrap<OggRecorderWrap>
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  OggRecorderWrap(const Napi::CallbackInfo &);
+  ~OggRecorderWrap();
+
+private:
+  struct Settled
+  {
+    uint64_t round;
+    bool ok;
+  };
+
+  struct Stream
+  {
+    Stream(uint32_t serial, int channels, uint32_t rate, uint16_t preSkip) : writer(serial, channels, rate, preSkip) {}
+
+    int fd{-1};
+    OggOpusWriter writer;
+    int64_t granule{0};
+    std::vector<unsigned char> held; // newest packet, written on the next one
+    bool haveHeld{false};
+    bool closing{false};
+    std::vector<std::vector<unsigned char>> chunks; // pages not yet on disk
+    // I/O thread only
+    uint64_t offset{0};
+    bool dirty{false};
+  };
+
+  // Everything the I/O thread touches. The thread is detached and holds its
+  // own reference, so a collected recorder never waits for the disk: the
+  // thread finishes the last round and exits on its own.
+  struct Core
+  {
+    // Options
+    std::chrono::milliseconds flushInterval{1000};
+    std::chrono::milliseconds fsyncInterval{0}; // 0 = only on close
+    bool fsyncOnClose{true};
+    size_t highWater{1 << 20};
+
+    // Shared with the I/O thread
+    std::mutex mu;
+    std::condition_variable wake;
+    std::unordered_map<uint32_t, std::unique_ptr<Stream>> streams;
+    size_t queuedBytes{0};
+    uint64_t requested{0}; // flush()/close() rounds asked for
+    uint64_t done{0};      // highest request covered by a finished round
+    bool syncRequested{false};
+    bool stop{false};
+    std::string lastError;
+    Napi::ThreadSafeFunction tsfn; // released by the thread as it exits
+
+    // JS thread only
+    std::vector<std::pair<uint64_t, Napi::Promise::Deferred>> waiters;
+    OggRecorderWrap *owner{nullptr}; // cleared by the destructor
+
+    // Stats
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> writeCalls{0};
+    std::atomic<uint64_t> fsyncs{0};
+    std::atomic<uint64_t> errors{0};
+
+    void Loop(std::shared_ptr<Core> self);
+    bool WriteRound(bool sync); // false if any write failed
+    void EndStreams();          // mu held
+    void Settle(Napi::Env env, Settled *settled);
+  };
+
+  // JS‑exposed methods
+  Napi::Value Open(const Napi::CallbackInfo &);
+  Napi::Value Write(const Napi::CallbackInfo &);
+  Napi::Value WriteBatch(const Napi::CallbackInfo &);
+  Napi::Value CloseStream(const Napi::CallbackInfo &);
+  Napi::Value Flush(const Napi::CallbackInfo &);
+  Napi::Value Stats(const Napi::CallbackInfo &);
+  Napi::Value Close(const Napi::CallbackInfo &);
+
+  // Helpers
+  bool Append(Napi::Env env, uint32_t id, const unsigned char *packet, size_t len); // mu held
+  void Kick();
+  Napi::Value Wait(Napi::Env env, uint64_t round);
+  void UpdatePin();
+
+  std::shared_ptr<Core> core_;
+
+  // JS thread only
+  uint32_t nextId_{0};
+  size_t openStreams_{0}; // opened and not yet passed to closeStream()
+  bool pinned_{false};    // Ref()'d while streams are open or promises pending
+  bool closed_{false};
+};
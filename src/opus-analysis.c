@@ -0,0 +1,70 @@
+/* opus-analysis.c – drives libopus' analysis.c outside of opus_encode.
+   Built as C against the libopus internal headers and config.h so the
+   TonalityAnalysisState layout matches the static library. */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "analysis.h"
+#include "opus_private.h"
+#include "opus-analysis.h"
+
+struct FrameAnalyzer
+{
+  TonalityAnalysisState state;
+  const CELTMode *mode;
+  opus_int32 rate;
+  int channels;
+};
+
+FrameAnalyzer *frame_analyzer_create(opus_int32 rate, int channels)
+{
+  FrameAnalyzer *fa;
+  int err;
+  /* Same restriction as opus_encode_native(). */
+  if (rate != 16000 && rate != 24000 && rate != 48000)
+    return NULL;
+  if (channels < 1 || channels > 2)
+    return NULL;
+  fa = (FrameAnalyzer *)calloc(1, sizeof(*fa));
+  if (!fa)
+    return NULL;
+  /* The analyser only uses the 48 kHz / 960 mode's MDCT tables, which are
+     static in non‑custom builds. */
+  fa->mode = opus_custom_mode_create(48000, 960, &err);
+  if (!fa->mode)
+  {
+    free(fa);
+    return NULL;
+  }
+  fa->rate = rate;
+  fa->channels = channels;
+  tonality_analysis_init(&fa->state, rate);
+  return fa;
+}
+
+void frame_analyzer_destroy(FrameAnalyzer *fa)
+{
+  free(fa);
+}
+
+void frame_analyzer_reset(FrameAnalyzer *fa)
+{
+  tonality_analysis_reset(&fa->state);
+}
+
+void frame_analyzer_run(FrameAnalyzer *fa, const opus_int16 *pcm, int frameSize, FrameAnalysis *out)
+{
+  AnalysisInfo info;
+  memset(&info, 0, sizeof(info));
+  /* Arguments mirror opus_encode(): c1 = 0, c2 = -2 downmixes stereo. */
+  run_analysis(&fa->state, fa->mode, pcm, frameSize, frameSize, 0, -2, fa->channels, fa->rate, 16, downmix_int, &info);
+  out->valid = info.valid;
+  out->vad = info.activity_probability;
+  out->music = info.music_prob;
+  out->activity = info.activity;
+  out->tonality = info.tonality;
+  out->noisiness = info.noisiness;
+  out->bandwidth = info.bandwidth;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Thin C bridge to libopus' internal tonality / speech‑music analysis
+// (opus/src/analysis.c). libopus keeps the encoder's own analysis state
+// private, so the wrapper drives the same module on a state it owns.
+
+#include "../libopus/opus/include/opus_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct FrameAnalyzer FrameAnalyzer;
+
+  typedef struct FrameAnalysis
+  {
+    int valid;        // 0 until the analyser has seen enough audio
+    float vad;        // voice activity probability, 0..1
+    float music;      // music (vs. speech) probability, 0..1
+    float activity;   // signal activity, 0..1
+    float tonality;   // 0 (noise‑like) .. 1 (tonal)
+    float noisiness;
+    int bandwidth;    // highest active band index (CELT bands, 0..20)
+  } FrameAnalysis;
+
+  // Returns nullptr if the rate is not supported (16, 24 or 48 kHz).
+  FrameAnalyzer *frame_analyzer_create(opus_int32 rate, int channels);
+  void frame_analyzer_destroy(FrameAnalyzer *fa);
+  void frame_analyzer_reset(FrameAnalyzer *fa);
+
+  // Analyses one interleaved 16‑bit frame of `frameSize` samples per channel.
+  void frame_analyzer_run(FrameAnalyzer *fa, const opus_int16 *pcm, int frameSize, FrameAnalysis *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+// Shared constants and helpers for the native classes in this addon.
+
+#include "../libopus/opus/include/opus.h"
+
+// -----------------------------------------------------------------------------
+// Constants (keep in sync with your JavaScript layer)
+// -----------------------------------------------------------------------------
+static constexpr int MAX_FRAME_SIZE = 5760;  // 120 ms @ 48 kHz mono
+static constexpr int MAX_PACKET_SIZE = 1276; // per Opus spec
+
+// Sample rates libopus encoders and decoders accept.
+inline bool IsOpusRate(int rate)
+{
+  return rate == 8000 || rate == 12000 || rate == 16000 || rate == 24000 || rate == 48000;
+}
+
+// -----------------------------------------------------------------------------
+// Utility: translate libopus error codes to strings
+// -----------------------------------------------------------------------------
+inline const char *StrError(int code)
+{
+  switch (code)
+  {
+  case OPUS_OK:
+    return "OK";
+  case OPUS_BAD_ARG:
+    return "One or more invalid/out‑of‑range arguments";
+  case OPUS_BUFFER_TOO_SMALL:
+    return "Buffer too small";
+  case OPUS_INTERNAL_ERROR:
+    return "Internal libopus error";
+  case OPUS_INVALID_PACKET:
+    return "Corrupted compressed data";
+  case OPUS_UNIMPLEMENTED:
+    return "Invalid/unsupported request";
+  case OPUS_INVALID_STATE:
+    return "Encoder/decoder in invalid state";
+  case OPUS_ALLOC_FAIL:
+    return "Memory allocation failed";
+  default:
+    return "Unknown libopus error";
+  }
+}
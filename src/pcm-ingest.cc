@@ -0,0 +1,369 @@
+// pcm-ingest.cc – native PCM reader/encoder feeding JS or an Ogg file.
+
+#include "pcm-ingest.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "ogg-opus.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+static constexpr size_t kReadBytes = 64 * 1024; // one pipe buffer per read()
+static constexpr int kPollMs = 100;             // how often stop() is noticed
+static constexpr size_t kMaxQueuedBatches = 4;  // then the reader blocks
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// new PcmIngest(fdOrPath, { rate = 48000, channels = 2, frameSize = 20 ms,
+//                           application, bitrate, complexity, batchFrames = 50,
+//                           format = 'packets' | 'ogg', outPath, serial })
+// -----------------------------------------------------------------------------
+PcmIngestWrap::PcmIngestWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<PcmIngestWrap>(info)
+{
+  Napi::Env env = info.Env();
+#ifndef _WIN32
+  if (info.Length() < 1 || !(info[0].IsNumber() || info[0].IsString()))
+  {
+    Napi::TypeError::New(env, "Expected (fd: number | path: string, options?: object)").ThrowAsJavaScriptException();
+    return;
+  }
+  if (info[0].IsNumber())
+    fd_ = info[0].ToNumber().Int32Value();
+  else
+    path_ = info[0].ToString().Utf8Value();
+
+  if (info.Length() > 1 && info[1].IsObject())
+  {
+    Napi::Object o = info[1].As<Napi::Object>();
+    if (o.Get("rate").IsNumber())
+      rate_ = o.Get("rate").ToNumber().Int32Value();
+    if (o.Get("channels").IsNumber())
+      channels_ = o.Get("channels").ToNumber().Int32Value();
+    if (o.Get("frameSize").IsNumber())
+      frameSize_ = o.Get("frameSize").ToNumber().Int32Value();
+    if (o.Get("application").IsNumber())
+      application_ = o.Get("application").ToNumber().Int32Value();
+    if (o.Get("bitrate").IsNumber())
+      bitrate_ = o.Get("bitrate").ToNumber().Int32Value();
+    if (o.Get("complexity").IsNumber())
+      complexity_ = o.Get("complexity").ToNumber().Int32Value();
+    if (o.Get("batchFrames").IsNumber())
+      batchFrames_ = o.Get("batchFrames").ToNumber().Int32Value();
+    if (o.Get("format").IsString())
+    {
+      std::string format = o.Get("format").ToString().Utf8Value();
+      if (format != "packets" && format != "ogg")
+      {
+        Napi::RangeError::New(env, "format must be 'packets' or 'ogg'").ThrowAsJavaScriptException();
+        return;
+      }
+      ogg_ = format == "ogg";
+    }
+    if (o.Get("outPath").IsString())
+    {
+      outPath_ = o.Get("outPath").ToString().Utf8Value();
+      ogg_ = true;
+    }
+    if (o.Get("serial").IsNumber())
+      serial_ = o.Get("serial").ToNumber().Uint32Value();
+  }
+
+  if (rate_ <= 0 || 48000 % rate_ != 0 || channels_ < 1 || channels_ > 2)
+  {
+    Napi::RangeError::New(env, "Unsupported sample rate or channel count").ThrowAsJavaScriptException();
+    return;
+  }
+  if (!frameSize_)
+    frameSize_ = rate_ / 50;
+  if (frameSize_ <= 0 || frameSize_ > MAX_FRAME_SIZE || batchFrames_ < 1 || (path_.empty() && fd_ < 0))
+  {
+    Napi::RangeError::New(env, "Invalid fd, frameSize or batchFrames").ThrowAsJavaScriptException();
+    return;
+  }
+
+  int err;
+  enc_ = opus_encoder_create(rate_, channels_, application_, &err);
+  if (err != OPUS_OK)
+  {
+    enc_ = nullptr;
+    Napi::Error::New(env, StrError(err)).ThrowAsJavaScriptException();
+    return;
+  }
+  if (bitrate_ != OPUS_AUTO)
+    opus_encoder_ctl(enc_, OPUS_SET_BITRATE(bitrate_));
+  if (complexity_ >= 0)
+    opus_encoder_ctl(enc_, OPUS_SET_COMPLEXITY(complexity_));
+#else
+  Napi::Error::New(env, "PcmIngest is only available on POSIX systems").ThrowAsJavaScriptException();
+#endif
+}
+
+PcmIngestWrap::~PcmIngestWrap()
+{
+  // Started instances are Ref()'d until the thread has been joined.
+  if (enc_)
+    opus_encoder_destroy(enc_);
+}
+
+// -----------------------------------------------------------------------------
+// Ingest thread
+// -----------------------------------------------------------------------------
+bool PcmIngestWrap::Emit(Batch *batch)
+{
+  ++batches_;
+  if (tsfn_.BlockingCall(batch, [this](Napi::Env env, Napi::Function cb, Batch *b) { Deliver(env, cb, b); }) != napi_ok)
+  {
+    delete batch;
+    return false;
+  }
+  return true;
+}
+
+void PcmIngestWrap::Loop()
+{
+#ifndef _WIN32
+  Batch *batch = new Batch;
+  std::string error;
+
+  // O_NONBLOCK: opening a FIFO would otherwise block, out of reach of stop(),
+  // until a writer shows up. Reads are gated by poll() below either way.
+  int fd = fd_;
+  if (!path_.empty() && (fd = ::open(path_.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)) < 0)
+    error = std::string("Failed to open input: ") + std::strerror(errno);
+
+  FILE *out = nullptr;
+  if (error.empty() && !outPath_.empty() && !(out = std::fopen(outPath_.c_str(), "wb")))
+    error = "Failed to open output file";
+
+  // Encoder lookahead sets pre‑skip and how many padded frames flush the tail.
+  opus_int32 lookahead = 0;
+  opus_encoder_ctl(enc_, OPUS_GET_LOOKAHEAD(&lookahead));
+  const int64_t scale = 48000 / rate_;
+  const int64_t preSkip = static_cast<int64_t>(lookahead) * scale;
+  std::unique_ptr<OggOpusWriter> writer;
+  if (ogg_)
+  {
+    writer.reset(new OggOpusWriter(serial_, channels_, static_cast<uint32_t>(rate_), static_cast<uint16_t>(preSkip)));
+    writer->WriteHeaders();
+  }
+
+  const size_t frameValues = static_cast<size_t>(frameSize_) * channels_;
+  const size_t frameBytes = frameValues * sizeof(opus_int16);
+  std::vector<opus_int16> buf((kReadBytes + frameBytes) / sizeof(opus_int16));
+  unsigned char *bytes = reinterpret_cast<unsigned char *>(buf.data());
+  unsigned char packet[MAX_PACKET_SIZE];
+  size_t have = 0;   // bytes buffered, always < frameBytes between reads
+  uint64_t frames = 0;
+  int inBatch = 0;
+
+  // Pages leave through the same path whether they go to JS or to the file.
+  auto flush = [&]() {
+    inBatch = 0;
+    if (writer)
+      batch->data = writer->TakeData();
+    if (batch->data.empty())
+      return; // Ogg page not complete yet
+    if (out)
+    {
+      if (std::fwrite(batch->data.data(), 1, batch->data.size(), out) != batch->data.size())
+        error = "Failed to write output file";
+      batch->data.clear();
+      return;
+    }
+    if (!Emit(batch))
+      error = "PcmIngest was torn down";
+    batch = new Batch;
+  };
+
+  auto encode = [&](const opus_int16 *pcm, bool last, int64_t endGranule) {
+    int len = opus_encode(enc_, pcm, frameSize_, packet, MAX_PACKET_SIZE);
+    if (len < 0)
+    {
+      error = StrError(len);
+      return;
+    }
+    ++frames;
+    ++frames_;
+    if (writer)
+      writer->WritePacket(packet, len, last ? endGranule : static_cast<int64_t>(frames) * frameSize_ * scale, last);
+    else
+    {
+      batch->data.insert(batch->data.end(), packet, packet + len);
+      batch->lengths.push_back(len);
+    }
+    if (++inBatch == batchFrames_ || last)
+      flush();
+  };
+
+  while (error.empty() && !stop_.load())
+  {
+    pollfd p{fd, POLLIN, 0};
+    int ready = ::poll(&p, 1, kPollMs);
+    if (ready < 0 && errno != EINTR)
+      error = std::string("poll failed: ") + std::strerror(errno);
+    if (ready <= 0)
+      continue;
+
+    ssize_t n = ::read(fd, bytes + have, kReadBytes + frameBytes - have);
+    if (n < 0)
+    {
+      if (errno != EINTR && errno != EAGAIN)
+        error = std::string("read failed: ") + std::strerror(errno);
+      continue;
+    }
+    if (n == 0)
+      break; // EOF
+    bytesRead_ += static_cast<uint64_t>(n);
+    have += static_cast<size_t>(n);
+
+    size_t used = 0;
+    for (; have - used >= frameBytes && error.empty(); used += frameBytes)
+    {
+      encode(reinterpret_cast<const opus_int16 *>(bytes + used), false, 0);
+      samples_ += static_cast<uint64_t>(frameSize_);
+    }
+    std::memmove(bytes, bytes + used, have - used);
+    have -= used;
+  }
+
+  // EOF or stop(): pad the partial frame and the encoder delay with silence,
+  // mark the last packet with the true end so players trim the padding.
+  if (error.empty())
+  {
+    samples_ += have / (channels_ * sizeof(opus_int16));
+    const int64_t samples = static_cast<int64_t>(samples_.load());
+    const int64_t endGranule = preSkip + samples * scale;
+    const uint64_t total =
+        std::max<uint64_t>(frames + 1, static_cast<uint64_t>((samples + lookahead + frameSize_ - 1) / frameSize_));
+    std::memset(bytes + have, 0, frameBytes - have);
+    while (frames < total && error.empty())
+    {
+      encode(buf.data(), frames + 1 == total, endGranule);
+      std::memset(bytes, 0, frameBytes);
+    }
+  }
+
+  if (out && std::fclose(out) != 0 && error.empty())
+    error = "Failed to write output file";
+  if (!path_.empty() && fd >= 0)
+    ::close(fd);
+
+  batch->data.clear();
+  batch->lengths.clear();
+  batch->done = true;
+  batch->error = error;
+  Emit(batch);
+#endif
+  tsfn_.Release();
+}
+
+// -----------------------------------------------------------------------------
+// Delivery (JS thread)
+// -----------------------------------------------------------------------------
+void PcmIngestWrap::Deliver(Napi::Env env, Napi::Function cb, Batch *batch)
+{
+  if (batch->done)
+  {
+    if (!batch->error.empty())
+      deferred_->Reject(Napi::Error::New(env, batch->error).Value());
+    else
+    {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("bytesRead", Napi::Number::New(env, static_cast<double>(bytesRead_.load())));
+      result.Set("frames", Napi::Number::New(env, static_cast<double>(frames_.load())));
+      result.Set("samples", Napi::Number::New(env, static_cast<double>(samples_.load())));
+      deferred_->Resolve(result);
+    }
+  }
+  else if (!cb.IsEmpty())
+  {
+    Napi::Buffer<char> data =
+        Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(batch->data.data()), batch->data.size());
+    if (ogg_)
+      cb.Call({data});
+    else
+    {
+      Napi::Int32Array lengths = Napi::Int32Array::New(env, batch->lengths.size());
+      std::copy(batch->lengths.begin(), batch->lengths.end(), lengths.Data());
+      cb.Call({data, lengths});
+    }
+  }
+  delete batch;
+}
+
+// -----------------------------------------------------------------------------
+// start(onData?) -> Promise<{ bytesRead, frames, samples }>
+// stop() – finish as if EOF had been reached
+// -----------------------------------------------------------------------------
+Napi::Value PcmIngestWrap::Start(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  bool hasCallback = info.Length() > 0 && info[0].IsFunction();
+  if (info.Length() > 0 && !info[0].IsUndefined() && !hasCallback)
+  {
+    Napi::TypeError::New(env, "Expected (onData?: function)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (started_)
+  {
+    Napi::Error::New(env, "PcmIngest can only be started once").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!hasCallback && outPath_.empty())
+  {
+    Napi::TypeError::New(env, "onData is required unless outPath is set").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  started_ = true;
+  running_ = true;
+
+  deferred_.reset(new Napi::Promise::Deferred(Napi::Promise::Deferred::New(env)));
+  Napi::Function cb = hasCallback ? info[0].As<Napi::Function>() : Napi::Function();
+  // The finalizer also runs at environment teardown (process exit, worker
+  // termination) while the source may still be open: stop the reader first.
+  tsfn_ = Napi::ThreadSafeFunction::New(env, cb, "PcmIngest", kMaxQueuedBatches, 1, [this](Napi::Env) {
+    stop_ = true;
+    thread_.join();
+    running_ = false;
+    Unref();
+  });
+  Ref(); // deliveries call back into this object
+  thread_ = std::thread(&PcmIngestWrap::Loop, this);
+  return deferred_->Promise();
+}
+
+Napi::Value PcmIngestWrap::Stop(const Napi::CallbackInfo &info)
+{
+  stop_ = true;
+  return info.Env().Undefined();
+}
+
+Napi::Value PcmIngestWrap::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("running", Napi::Boolean::New(env, running_.load()));
+  stats.Set("bytesRead", Napi::Number::New(env, static_cast<double>(bytesRead_.load())));
+  stats.Set("frames", Napi::Number::New(env, static_cast<double>(frames_.load())));
+  stats.Set("batches", Napi::Number::New(env, static_cast<double>(batches_.load())));
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object PcmIngestWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<PcmIngestWrap>::DefineClass(env, "PcmIngest", {
+                                                                                           InstanceMethod("start", &PcmIngestWrap::Start),
+                                                                                           InstanceMethod("stop", &PcmIngestWrap::Stop),
+                                                                                           InstanceMethod("stats", &PcmIngestWrap::Stats),
+                                                                                       });
+  exports.Set("PcmIngest", ctor);
+  return exports;
+}
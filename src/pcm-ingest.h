@@ -0,0 +1,73 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// PcmIngest – reads raw interleaved s16le PCM from a file descriptor or path
+// (pipe, FIFO, file, socket) on a native thread, frames and encodes it, and
+// hands the packets to JS in batches – or writes them as Ogg Opus straight to
+// a file. The PCM itself never enters the V8 heap. POSIX only.
+// -----------------------------------------------------------------------------
+class PcmIngestWrap : public Napi::ObjectWrap<PcmIngestWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  PcmIngestWrap(const Napi::CallbackInfo &);
+  ~PcmIngestWrap();
+
+private:
+  // One delivery to JS; `done` is the last one and settles the Promise.
+  struct Batch
+  {
+    std::vector<unsigned char> data; // packets back to back, or Ogg pages
+    std::vector<int32_t> lengths;    // packet mode only
+    bool done{false};
+    std::string error;
+  };
+
+  // JS‑exposed methods
+  Napi::Value Start(const Napi::CallbackInfo &);
+  Napi::Value Stop(const Napi::CallbackInfo &);
+  Napi::Value Stats(const Napi::CallbackInfo &);
+
+  // Helpers
+  void Loop();
+  bool Emit(Batch *batch);                                  // ingest thread
+  void Deliver(Napi::Env env, Napi::Function cb, Batch *batch); // JS thread
+
+  // Options
+  int fd_{-1};
+  std::string path_; // opened (and closed) by the ingest thread instead of fd_
+  opus_int32 rate_{48000};
+  int channels_{2};
+  int frameSize_{0};
+  int application_{OPUS_APPLICATION_AUDIO};
+  opus_int32 bitrate_{OPUS_AUTO};
+  int complexity_{-1};
+  int batchFrames_{50};
+  bool ogg_{false};
+  std::string outPath_;
+  uint32_t serial_{0x4f707573}; // "Opus"
+
+  // State
+  OpusEncoder *enc_{nullptr};
+  std::thread thread_;
+  Napi::ThreadSafeFunction tsfn_;
+  std::unique_ptr<Napi::Promise::Deferred> deferred_;
+  bool started_{false};
+  std::atomic<bool> running_{false};
+  std::atomic<bool> stop_{false};
+
+  // Stats
+  std::atomic<uint64_t> bytesRead_{0};
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> samples_{0}; // per channel, input only (no padding)
+};
@@ -0,0 +1,311 @@
+// rate-controller.cc – network‑aware bitrate / FEC / DTX / frame size policy.
+
+#include "rate-controller.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include "node-opus.h"
+
+// -----------------------------------------------------------------------------
+// RateControl
+// -----------------------------------------------------------------------------
+RateControl::RateControl(const Config &config) : config_(config)
+{
+  decision_.bitrate = config.startBitrate > 0 ? config.startBitrate : (config.minBitrate + config.maxBitrate) / 2;
+  decision_.dtx = config.dtx == kDtxOn;
+}
+
+const RateDecision &RateControl::Update(const RateReport &r)
+{
+  // The smoothed RTT paces probing: a step up is only judged once reports
+  // sent after it can have come back, so never probe faster than ~2 RTTs.
+  const double a = config_.smoothing;
+  double loss = std::min(1.0, std::max(0.0, r.loss));
+  if (first_)
+  {
+    loss_ = loss;
+    rtt_ = r.rttMs;
+    jitter_ = r.jitterMs;
+    lastIncreaseMs_ = r.nowMs;
+    first_ = false;
+  }
+  else
+  {
+    loss_ = a * loss + (1 - a) * loss_;
+    rtt_ = a * r.rttMs + (1 - a) * rtt_;
+    jitter_ = a * r.jitterMs + (1 - a) * jitter_;
+  }
+
+  RateDecision &d = decision_;
+  double bitrate = d.bitrate;
+  bool queueing = jitter_ > config_.highJitterMs;
+  d.congested = loss_ > config_.highLoss || queueing;
+
+  if (loss_ > config_.highLoss)
+  {
+    // Multiplicative decrease proportional to loss (as in loss‑based GCC).
+    bitrate *= 1.0 - 0.5 * loss_;
+  }
+  else if (queueing)
+  {
+    bitrate *= 0.85;
+  }
+  else if (loss_ < config_.lowLoss && r.nowMs - lastIncreaseMs_ >= std::max(config_.increaseIntervalMs, 2 * rtt_))
+  {
+    bitrate *= config_.increaseFactor;
+    lastIncreaseMs_ = r.nowMs;
+  }
+  if (d.congested)
+    lastIncreaseMs_ = r.nowMs; // hold off probing right after a back‑off
+  d.bitrate = static_cast<opus_int32>(std::min<double>(config_.maxBitrate, std::max<double>(config_.minBitrate, bitrate)));
+
+  // In‑band FEC with hysteresis; the loss hint steers how much LBRR SILK spends.
+  if (config_.fec)
+  {
+    if (!d.fec && loss_ > config_.fecOnLoss)
+      d.fec = true;
+    else if (d.fec && loss_ < config_.fecOffLoss)
+      d.fec = false;
+  }
+  d.lossPerc = std::min(config_.maxLossPerc, static_cast<int>(std::ceil(loss_ * 100.0)));
+
+  d.dtx = config_.dtx == kDtxOn || (config_.dtx == kDtxAuto && d.congested);
+
+  if (config_.adaptFrameSize)
+  {
+    // Longer packets amortise IP/UDP/RTP overhead at low rates, but lose more
+    // audio per lost packet, so stay at 20 ms when loss is noticeable.
+    int frameMs = d.bitrate < 12000 ? 60 : d.bitrate < 24000 ? 40 : 20;
+    if (loss_ > config_.lowLoss * 2.5)
+      frameMs = std::min(frameMs, 20);
+    d.frameMs = frameMs;
+  }
+  return d;
+}
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// -----------------------------------------------------------------------------
+bool RateControllerWrap::ParseConfig(Napi::Env env, Napi::Value value, RateControl::Config *c)
+{
+  if (value.IsUndefined())
+    return true;
+  if (!value.IsObject())
+  {
+    Napi::TypeError::New(env, "options must be an object").ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Object o = value.As<Napi::Object>();
+  auto num = [&](const char *key, double *out) {
+    if (o.Get(key).IsNumber())
+      *out = o.Get(key).ToNumber().DoubleValue();
+  };
+  double minBitrate = c->minBitrate, maxBitrate = c->maxBitrate, startBitrate = c->startBitrate, maxLossPerc = c->maxLossPerc;
+  num("minBitrate", &minBitrate);
+  num("maxBitrate", &maxBitrate);
+  num("startBitrate", &startBitrate);
+  num("maxLossPerc", &maxLossPerc);
+  num("smoothing", &c->smoothing);
+  num("highLoss", &c->highLoss);
+  num("lowLoss", &c->lowLoss);
+  num("highJitterMs", &c->highJitterMs);
+  num("increaseIntervalMs", &c->increaseIntervalMs);
+  num("increaseFactor", &c->increaseFactor);
+  num("fecOnLoss", &c->fecOnLoss);
+  num("fecOffLoss", &c->fecOffLoss);
+  c->minBitrate = static_cast<opus_int32>(minBitrate);
+  c->maxBitrate = static_cast<opus_int32>(maxBitrate);
+  c->startBitrate = static_cast<opus_int32>(startBitrate);
+  c->maxLossPerc = static_cast<int>(maxLossPerc);
+  if (o.Get("fec").IsBoolean())
+    c->fec = o.Get("fec").ToBoolean().Value();
+  if (o.Get("adaptFrameSize").IsBoolean())
+    c->adaptFrameSize = o.Get("adaptFrameSize").ToBoolean().Value();
+  Napi::Value dtx = o.Get("dtx");
+  if (dtx.IsBoolean())
+    c->dtx = dtx.ToBoolean().Value() ? RateControl::kDtxOn : RateControl::kDtxOff;
+  else if (dtx.IsString() && dtx.ToString().Utf8Value() == "auto")
+    c->dtx = RateControl::kDtxAuto;
+  else if (!dtx.IsUndefined())
+  {
+    Napi::TypeError::New(env, "options.dtx must be a boolean or 'auto'").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  if (c->minBitrate < 500 || c->maxBitrate < c->minBitrate || c->smoothing <= 0 || c->smoothing > 1 ||
+      c->maxLossPerc < 0 || c->maxLossPerc > 100 || c->fecOffLoss > c->fecOnLoss ||
+      (c->startBitrate != 0 && (c->startBitrate < c->minBitrate || c->startBitrate > c->maxBitrate)))
+  {
+    Napi::RangeError::New(env, "Invalid RateController options").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
+}
+
+RateControllerWrap::RateControllerWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<RateControllerWrap>(info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !OpusEncoderWrap::FromValue(env, info[0]))
+  {
+    Napi::TypeError::New(env, "Expected (encoder: OpusEncoder, options?: object)").ThrowAsJavaScriptException();
+    return;
+  }
+  RateControl::Config config;
+  if (!ParseConfig(env, info.Length() > 1 ? info[1] : env.Undefined(), &config))
+    return;
+  control_ = new RateControl(config);
+  encoderRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+}
+
+RateControllerWrap::~RateControllerWrap()
+{
+  delete control_;
+}
+
+// -----------------------------------------------------------------------------
+// Applying decisions – only the CTLs whose value changed are issued.
+// -----------------------------------------------------------------------------
+int RateControllerWrap::Apply(const RateDecision &d)
+{
+  OpusEncoderWrap *wrap = OpusEncoderWrap::Unwrap(encoderRef_.Value());
+  ::OpusEncoder *enc = wrap->RawEncoder();
+  if (!enc)
+    return OPUS_ALLOC_FAIL;
+
+  int rc = OPUS_OK;
+  if (rc == OPUS_OK && (!appliedOnce_ || d.bitrate != applied_.bitrate))
+    rc = opus_encoder_ctl(enc, OPUS_SET_BITRATE(d.bitrate));
+  if (rc == OPUS_OK && (!appliedOnce_ || d.fec != applied_.fec))
+    rc = opus_encoder_ctl(enc, OPUS_SET_INBAND_FEC(d.fec ? 1 : 0));
+  if (rc == OPUS_OK && (!appliedOnce_ || d.lossPerc != applied_.lossPerc))
+    rc = opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(d.lossPerc));
+  if (rc == OPUS_OK && (!appliedOnce_ || d.dtx != applied_.dtx))
+    rc = opus_encoder_ctl(enc, OPUS_SET_DTX(d.dtx ? 1 : 0));
+  if (rc == OPUS_OK)
+  {
+    applied_ = d;
+    appliedOnce_ = true;
+  }
+  return rc;
+}
+
+Napi::Object RateControllerWrap::DecisionToObject(Napi::Env env, const RateDecision &d)
+{
+  Napi::Object o = Napi::Object::New(env);
+  o.Set("bitrate", Napi::Number::New(env, d.bitrate));
+  o.Set("fec", Napi::Boolean::New(env, d.fec));
+  o.Set("lossPerc", Napi::Number::New(env, d.lossPerc));
+  o.Set("dtx", Napi::Boolean::New(env, d.dtx));
+  o.Set("frameMs", Napi::Number::New(env, d.frameMs));
+  o.Set("congested", Napi::Boolean::New(env, d.congested));
+  return o;
+}
+
+static RateReport ParseReport(Napi::Object o, double defaultNowMs)
+{
+  RateReport r;
+  r.loss = o.Get("loss").IsNumber() ? o.Get("loss").ToNumber().DoubleValue() : 0;
+  r.rttMs = o.Get("rttMs").IsNumber() ? o.Get("rttMs").ToNumber().DoubleValue() : 0;
+  r.jitterMs = o.Get("jitterMs").IsNumber() ? o.Get("jitterMs").ToNumber().DoubleValue() : 0;
+  r.nowMs = o.Get("nowMs").IsNumber() ? o.Get("nowMs").ToNumber().DoubleValue() : defaultNowMs;
+  return r;
+}
+
+// -----------------------------------------------------------------------------
+// report({ loss, rttMs, jitterMs, nowMs? }) -> decision
+// -----------------------------------------------------------------------------
+Napi::Value RateControllerWrap::Report(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject())
+  {
+    Napi::TypeError::New(env, "Expected (report: { loss, rttMs, jitterMs, nowMs? })").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  OpusEncoderWrap *wrap = OpusEncoderWrap::Unwrap(encoderRef_.Value());
+  if (wrap->asyncPending_ != 0)
+  {
+    Napi::Error::New(env, "Encoder has pending async work").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  double now = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  const RateDecision &d = control_->Update(ParseReport(info[0].As<Napi::Object>(), now));
+  int rc = Apply(d);
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return DecisionToObject(env, d);
+}
+
+Napi::Value RateControllerWrap::GetDecision(const Napi::CallbackInfo &info)
+{
+  return DecisionToObject(info.Env(), control_->Current());
+}
+
+// -----------------------------------------------------------------------------
+// RateController.simulate(options, trace, intervalMs = 1000) -> decision[]
+// Each trace step is a report ({ loss, rttMs, jitterMs }) or a bottleneck
+// ({ capacityKbps, rttMs? }): then the step's loss is the share of the current
+// bitrate (plus overheadKbps) that does not fit. No clocks, no encoder, so the
+// result depends only on the inputs.
+// -----------------------------------------------------------------------------
+Napi::Value RateControllerWrap::Simulate(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[1].IsArray())
+  {
+    Napi::TypeError::New(env, "Expected (options: object | undefined, trace: object[], intervalMs?: number)")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  RateControl::Config config;
+  if (!ParseConfig(env, info[0], &config))
+    return env.Null();
+  double intervalMs = info.Length() > 2 && info[2].IsNumber() ? info[2].ToNumber().DoubleValue() : 1000.0;
+  double overheadKbps = 0;
+  if (info[0].IsObject() && info[0].As<Napi::Object>().Get("overheadKbps").IsNumber())
+    overheadKbps = info[0].As<Napi::Object>().Get("overheadKbps").ToNumber().DoubleValue();
+
+  RateControl control(config);
+  Napi::Array trace = info[1].As<Napi::Array>();
+  Napi::Array result = Napi::Array::New(env, trace.Length());
+  for (uint32_t i = 0; i < trace.Length(); ++i)
+  {
+    if (!trace.Get(i).IsObject())
+    {
+      Napi::TypeError::New(env, "Trace entries must be objects").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Object step = trace.Get(i).As<Napi::Object>();
+    RateReport r = ParseReport(step, i * intervalMs);
+    if (step.Get("capacityKbps").IsNumber())
+    {
+      double sendKbps = control.Current().bitrate / 1000.0 + overheadKbps;
+      double capacity = step.Get("capacityKbps").ToNumber().DoubleValue();
+      r.loss = sendKbps > capacity ? 1.0 - capacity / sendKbps : 0.0;
+    }
+    Napi::Object o = DecisionToObject(env, control.Update(r));
+    o.Set("loss", Napi::Number::New(env, r.loss));
+    o.Set("smoothedLoss", Napi::Number::New(env, control.SmoothedLoss()));
+    result.Set(i, o);
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object RateControllerWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<RateControllerWrap>::DefineClass(env, "RateController", {
+                                                                                                     InstanceMethod("report", &RateControllerWrap::Report),
+                                                                                                     InstanceAccessor("decision", &RateControllerWrap::GetDecision, nullptr),
+                                                                                                     StaticMethod("simulate", &RateControllerWrap::Simulate),
+                                                                                                 });
+  exports.Set("RateController", ctor);
+  return exports;
+}
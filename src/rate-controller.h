@@ -0,0 +1,103 @@
+#pragma once
+
+#include <napi.h>
+#include <cstdint>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// RateControl – loss/RTT/jitter driven encoder policy (no N‑API, deterministic).
+// Each receiver report is smoothed and turns into one Decision covering
+// bitrate, in‑band FEC, expected loss, DTX and frame duration together.
+// -----------------------------------------------------------------------------
+struct RateReport
+{
+  double loss{0};     // fraction lost since the last report, 0..1
+  double rttMs{0};
+  double jitterMs{0};
+  double nowMs{0};    // report time; only differences matter
+};
+
+struct RateDecision
+{
+  opus_int32 bitrate{0};
+  bool fec{false};
+  int lossPerc{0};    // OPUS_SET_PACKET_LOSS_PERC
+  bool dtx{false};
+  int frameMs{20};    // suggested packet duration; the caller sizes frames
+  bool congested{false};
+};
+
+class RateControl
+{
+public:
+  enum DtxPolicy
+  {
+    kDtxOff,
+    kDtxOn,
+    kDtxAuto // only while congested
+  };
+
+  struct Config
+  {
+    opus_int32 minBitrate{6000};
+    opus_int32 maxBitrate{128000};
+    opus_int32 startBitrate{0};   // 0: halfway between min and max, else within them
+    double smoothing{0.3};        // EWMA weight of the newest report
+    double highLoss{0.10};        // back off above this smoothed loss
+    double lowLoss{0.02};         // probe upwards below this
+    double highJitterMs{40};      // treat as queue build‑up above this
+    double increaseIntervalMs{1000}; // at least 2 × smoothed RTT
+    double increaseFactor{1.08};
+    double fecOnLoss{0.02};       // hysteresis for in‑band FEC
+    double fecOffLoss{0.01};
+    int maxLossPerc{30};
+    bool fec{true};
+    DtxPolicy dtx{kDtxAuto};
+    bool adaptFrameSize{true};
+  };
+
+  explicit RateControl(const Config &config);
+
+  const RateDecision &Update(const RateReport &report);
+  const RateDecision &Current() const { return decision_; }
+  double SmoothedLoss() const { return loss_; }
+
+private:
+  Config config_;
+  RateDecision decision_;
+  double loss_{0};
+  double rtt_{0};
+  double jitter_{0};
+  double lastIncreaseMs_{0};
+  bool first_{true};
+};
+
+// -----------------------------------------------------------------------------
+// RateController (JS) – RateControl attached to an OpusEncoder.
+// report() applies the decision through encoder CTLs; the static simulate()
+// runs the same policy over a scripted network trace without an encoder.
+// -----------------------------------------------------------------------------
+class RateControllerWrap : public Napi::ObjectWrap<RateControllerWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  RateControllerWrap(const Napi::CallbackInfo &);
+  ~RateControllerWrap();
+
+private:
+  // JS‑exposed methods
+  Napi::Value Report(const Napi::CallbackInfo &);
+  Napi::Value GetDecision(const Napi::CallbackInfo &);
+  static Napi::Value Simulate(const Napi::CallbackInfo &);
+
+  // Helpers
+  static bool ParseConfig(Napi::Env env, Napi::Value value, RateControl::Config *config);
+  static Napi::Object DecisionToObject(Napi::Env env, const RateDecision &d);
+  int Apply(const RateDecision &d);
+
+  // Members
+  RateControl *control_{nullptr};
+  Napi::ObjectReference encoderRef_;
+  RateDecision applied_;
+  bool appliedOnce_{false};
+};
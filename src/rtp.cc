@@ -0,0 +1,532 @@
+// rtp.cc – RTP packetization of Opus frames (RFC 7587).
+
+#include "rtp.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include "byte-view.h"
+#include "node-opus.h"
+
+static constexpr size_t kBatchStride = 8; // Int32 slots per packet in parseBatch()
+
+static inline uint16_t GetBE16(const unsigned char *p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+static inline uint32_t GetBE32(const unsigned char *p)
+{
+  return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+static inline void PutBE16(unsigned char *p, uint16_t v)
+{
+  p[0] = static_cast<unsigned char>(v >> 8);
+  p[1] = static_cast<unsigned char>(v);
+}
+static inline void PutBE32(unsigned char *p, uint32_t v)
+{
+  p[0] = static_cast<unsigned char>(v >> 24);
+  p[1] = static_cast<unsigned char>(v >> 16);
+  p[2] = static_cast<unsigned char>(v >> 8);
+  p[3] = static_cast<unsigned char>(v);
+}
+
+// -----------------------------------------------------------------------------
+// Header parse / write
+// -----------------------------------------------------------------------------
+bool ParseRtp(const unsigned char *data, size_t len, int audioLevelId, RtpHeader *out)
+{
+  if (len < 12 || (data[0] >> 6) != 2)
+    return false;
+  size_t offset = 12 + 4 * static_cast<size_t>(data[0] & 0x0f); // CSRCs
+  size_t end = len;
+  if (data[0] & 0x20) // padding: last byte is the pad count
+  {
+    if (data[len - 1] == 0 || data[len - 1] > len)
+      return false;
+    end -= data[len - 1];
+  }
+  out->marker = (data[1] & 0x80) != 0;
+  out->payloadType = data[1] & 0x7f;
+  out->sequence = GetBE16(data + 2);
+  out->timestamp = GetBE32(data + 4);
+  out->ssrc = GetBE32(data + 8);
+  out->audioLevel = -1;
+  out->voice = false;
+
+  if (data[0] & 0x10) // header extension
+  {
+    if (offset + 4 > end)
+      return false;
+    uint16_t profile = GetBE16(data + offset);
+    size_t extLen = 4 * static_cast<size_t>(GetBE16(data + offset + 2));
+    size_t ext = offset + 4;
+    if (ext + extLen > end)
+      return false;
+    if (profile == 0xbede) // RFC 8285 one‑byte elements
+    {
+      for (size_t i = ext; i < ext + extLen;)
+      {
+        int id = data[i] >> 4;
+        if (id == 0) // padding byte
+        {
+          ++i;
+          continue;
+        }
+        if (id == 15)
+          break;
+        size_t elen = (data[i] & 0x0f) + 1;
+        if (i + 1 + elen > ext + extLen)
+          break;
+        if (id == audioLevelId)
+        {
+          out->voice = (data[i + 1] & 0x80) != 0;
+          out->audioLevel = data[i + 1] & 0x7f;
+        }
+        i += 1 + elen;
+      }
+    }
+    offset = ext + extLen;
+  }
+  if (offset > end)
+    return false;
+  out->payloadOffset = offset;
+  out->payloadLength = end - offset;
+  return true;
+}
+
+size_t WriteRtpHeader(unsigned char *out, const RtpHeader &h, int audioLevelId)
+{
+  bool ext = h.audioLevel >= 0;
+  out[0] = static_cast<unsigned char>(0x80 | (ext ? 0x10 : 0));
+  out[1] = static_cast<unsigned char>((h.marker ? 0x80 : 0) | (h.payloadType & 0x7f));
+  PutBE16(out + 2, h.sequence);
+  PutBE32(out + 4, h.timestamp);
+  PutBE32(out + 8, h.ssrc);
+  if (!ext)
+    return 12;
+  PutBE16(out + 12, 0xbede);
+  PutBE16(out + 14, 1); // one 32‑bit word of elements
+  out[16] = static_cast<unsigned char>(audioLevelId << 4); // len - 1 = 0
+  out[17] = static_cast<unsigned char>((h.voice ? 0x80 : 0) | (h.audioLevel & 0x7f));
+  out[18] = out[19] = 0; // padding
+  return kRtpMaxHeader;
+}
+
+// -----------------------------------------------------------------------------
+// RED (RFC 2198)
+// -----------------------------------------------------------------------------
+bool ParseRed(const unsigned char *data, size_t len, std::vector<RedBlock> *blocks)
+{
+  blocks->clear();
+  size_t pos = 0, dataBytes = 0;
+  for (;;)
+  {
+    if (pos >= len)
+      return false;
+    RedBlock b;
+    b.payloadType = data[pos] & 0x7f;
+    if (!(data[pos] & 0x80)) // F = 0: primary, one‑byte header
+    {
+      ++pos;
+      blocks->push_back(b);
+      break;
+    }
+    if (pos + 4 > len)
+      return false;
+    b.timestampOffset = static_cast<uint32_t>(data[pos + 1]) << 6 | data[pos + 2] >> 2;
+    b.length = static_cast<size_t>(data[pos + 2] & 0x03) << 8 | data[pos + 3];
+    dataBytes += b.length;
+    pos += 4;
+    blocks->push_back(b);
+  }
+  if (pos + dataBytes > len)
+    return false;
+  for (RedBlock &b : *blocks)
+  {
+    b.data = data + pos;
+    if (&b == &blocks->back())
+      b.length = len - pos;
+    pos += b.length;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Constructor
+// new RtpPacketizer(encoder, { ssrc?, payloadType = 111, sequence?, timestamp?,
+//                              audioLevelId = 1, red?: { payloadType, distance = 1 } })
+// -----------------------------------------------------------------------------
+RtpPacketizerWrap::RtpPacketizerWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<RtpPacketizerWrap>(info)
+{
+  Napi::Env env = info.Env();
+  OpusEncoderWrap *codec = info.Length() > 0 ? OpusEncoderWrap::FromValue(env, info[0]) : nullptr;
+  if (!codec || (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsObject()))
+  {
+    Napi::TypeError::New(env, "Expected (encoder: OpusEncoder, options?: object)").ThrowAsJavaScriptException();
+    return;
+  }
+  if (48000 % codec->Rate() != 0)
+  {
+    Napi::RangeError::New(env, "Encoder rate must divide 48000").ThrowAsJavaScriptException();
+    return;
+  }
+
+  // RFC 3550 wants random initial values for SSRC, sequence and timestamp.
+  std::random_device rd;
+  ssrc_ = rd();
+  sequence_ = static_cast<uint16_t>(rd());
+  timestamp_ = rd();
+  if (info.Length() > 1 && info[1].IsObject())
+  {
+    Napi::Object o = info[1].As<Napi::Object>();
+    if (o.Get("ssrc").IsNumber())
+      ssrc_ = static_cast<uint32_t>(o.Get("ssrc").ToNumber().Int64Value());
+    if (o.Get("sequence").IsNumber())
+      sequence_ = static_cast<uint16_t>(o.Get("sequence").ToNumber().Int64Value());
+    if (o.Get("timestamp").IsNumber())
+      timestamp_ = static_cast<uint32_t>(o.Get("timestamp").ToNumber().Int64Value());
+    if (o.Get("payloadType").IsNumber())
+      payloadType_ = o.Get("payloadType").ToNumber().Int32Value();
+    if (o.Get("audioLevelId").IsNumber())
+      audioLevelId_ = o.Get("audioLevelId").ToNumber().Int32Value();
+    if (o.Get("red").IsObject())
+    {
+      Napi::Object red = o.Get("red").As<Napi::Object>();
+      if (!red.Get("payloadType").IsNumber())
+      {
+        Napi::TypeError::New(env, "red.payloadType must be a number").ThrowAsJavaScriptException();
+        return;
+      }
+      redPayloadType_ = red.Get("payloadType").ToNumber().Int32Value();
+      if (red.Get("distance").IsNumber())
+        redDistance_ = red.Get("distance").ToNumber().Int32Value();
+      if (redPayloadType_ < 0 || redPayloadType_ > 127 || redPayloadType_ == payloadType_ || redDistance_ < 1 ||
+          redDistance_ > kRedMaxDistance)
+      {
+        Napi::RangeError::New(env, "red.payloadType must be 0..127 and differ from payloadType; red.distance 1..3")
+            .ThrowAsJavaScriptException();
+        return;
+      }
+    }
+  }
+  if (payloadType_ < 0 || payloadType_ > 127 || audioLevelId_ < 1 || audioLevelId_ > 14)
+  {
+    Napi::RangeError::New(env, "payloadType must be 0..127 and audioLevelId 1..14").ThrowAsJavaScriptException();
+    return;
+  }
+
+  clockScale_ = 48000 / codec->Rate();
+  packet_.resize(kRtpMaxHeader + 4 * kRedMaxDistance + 1 + (kRedMaxDistance + 1) * static_cast<size_t>(MAX_PACKET_SIZE));
+  outPcm_.resize(static_cast<size_t>(codec->Channels()) * MAX_FRAME_SIZE);
+  encoderRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+}
+
+// -----------------------------------------------------------------------------
+// packetize(pcm, { marker?, audioLevel?, voice? }?) -> Buffer (RTP packet)
+// The encoder writes its packet directly behind the header; the result is the
+// only allocation. Returns an empty Buffer if the encoder produced nothing
+// (silence 'skip' mode); the timestamp still advances.
+// -----------------------------------------------------------------------------
+Napi::Value RtpPacketizerWrap::Packetize(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  OpusEncoderWrap *codec = OpusEncoderWrap::Unwrap(encoderRef_.Value());
+  ByteView view;
+  if (info.Length() < 1 || !GetByteView(env, info[0], &view) ||
+      (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsObject()))
+  {
+    Napi::TypeError::New(env, "Expected (pcm: Buffer | ArrayBufferView | ArrayBuffer, options?: object)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (codec->asyncPending_ != 0)
+  {
+    Napi::Error::New(env, "Encoder has pending async work").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int channels = codec->Channels();
+  if (view.length % (2 * channels) != 0 || view.length / 2 / channels > MAX_FRAME_SIZE)
+  {
+    Napi::RangeError::New(env, "PCM must be one frame of channels * 2 byte samples").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int frameSize = static_cast<int>(view.length / 2 / channels);
+
+  RtpHeader h;
+  h.payloadType = payloadType_;
+  h.sequence = sequence_;
+  h.timestamp = timestamp_;
+  h.ssrc = ssrc_;
+  if (info.Length() > 1 && info[1].IsObject())
+  {
+    Napi::Object o = info[1].As<Napi::Object>();
+    h.marker = o.Get("marker").ToBoolean().Value();
+    if (o.Get("audioLevel").IsNumber())
+      h.audioLevel = std::min(127, std::max(0, o.Get("audioLevel").ToNumber().Int32Value()));
+    h.voice = o.Get("voice").ToBoolean().Value();
+  }
+
+  if (redPayloadType_ >= 0)
+    h.payloadType = redPayloadType_;
+  unsigned char *p = packet_.data();
+  size_t headerLen = WriteRtpHeader(p, h, audioLevelId_);
+
+  // RED: block headers and the redundant copies go first; the primary is the
+  // last block, so the encoder can still write it in place.
+  size_t redLen = 0;
+  if (redPayloadType_ >= 0)
+  {
+    size_t blocks = 0, dataLen = 0;
+    for (const Sent &s : history_)
+      if (timestamp_ - s.timestamp <= kRedMaxOffset && s.data.size() <= kRedMaxBlock)
+        ++blocks;
+    unsigned char *hdr = p + headerLen;
+    unsigned char *body = hdr + 4 * blocks + 1;
+    for (const Sent &s : history_)
+    {
+      uint32_t offset = timestamp_ - s.timestamp;
+      if (offset > kRedMaxOffset || s.data.size() > kRedMaxBlock)
+        continue;
+      hdr[0] = static_cast<unsigned char>(0x80 | payloadType_);
+      hdr[1] = static_cast<unsigned char>(offset >> 6);
+      hdr[2] = static_cast<unsigned char>((offset & 0x3f) << 2 | s.data.size() >> 8);
+      hdr[3] = static_cast<unsigned char>(s.data.size());
+      hdr += 4;
+      std::memcpy(body + dataLen, s.data.data(), s.data.size());
+      dataLen += s.data.size();
+    }
+    *hdr = static_cast<unsigned char>(payloadType_);
+    redLen = 4 * blocks + 1 + dataLen;
+  }
+
+  unsigned char *primary = p + headerLen + redLen;
+  int clen = codec->EncodeInto(AlignedPcm(view, &inPcm_), frameSize, primary, MAX_PACKET_SIZE);
+  if (clen < 0)
+  {
+    Napi::Error::New(env, StrError(clen)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint32_t ts = timestamp_;
+  timestamp_ += static_cast<uint32_t>(frameSize * clockScale_);
+  if (clen == 0)
+    return Napi::Buffer<unsigned char>::New(env, 0);
+  if (redPayloadType_ >= 0)
+  {
+    if (history_.size() == static_cast<size_t>(redDistance_))
+      history_.pop_front();
+    history_.push_back({ts, std::vector<unsigned char>(primary, primary + clen)});
+  }
+  ++sequence_;
+  return Napi::Buffer<unsigned char>::Copy(env, p, headerLen + redLen + clen);
+}
+
+// -----------------------------------------------------------------------------
+// depacketize(packet) -> PCM Buffer
+// Decodes with the attached encoder's decoder and returns all audio since the
+// previous packet: frames lost in between are first recovered from RED copies
+// carried by this packet, and whatever is still missing is concealed (PLC).
+// Late or duplicate packets return an empty Buffer.
+// -----------------------------------------------------------------------------
+Napi::Value RtpPacketizerWrap::Depacketize(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  OpusEncoderWrap *codec = OpusEncoderWrap::Unwrap(encoderRef_.Value());
+  ByteView view;
+  if (info.Length() < 1 || !GetByteView(env, info[0], &view))
+  {
+    Napi::TypeError::New(env, "Expected (packet: Buffer | ArrayBufferView | ArrayBuffer)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (codec->asyncPending_ != 0)
+  {
+    Napi::Error::New(env, "Encoder has pending async work").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  RtpHeader h;
+  if (!ParseRtp(view.data, view.length, audioLevelId_, &h))
+  {
+    Napi::Error::New(env, "Malformed RTP packet").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::vector<RedBlock> blocks;
+  const unsigned char *payload = view.data + h.payloadOffset;
+  if (redPayloadType_ >= 0 && h.payloadType == redPayloadType_)
+  {
+    if (!ParseRed(payload, h.payloadLength, &blocks) || blocks.back().payloadType != payloadType_)
+    {
+      Napi::Error::New(env, "Malformed RED payload").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  else if (h.payloadType == payloadType_)
+  {
+    RedBlock primary;
+    primary.data = payload;
+    primary.length = h.payloadLength;
+    blocks.push_back(primary);
+  }
+  else
+  {
+    Napi::Error::New(env, "Unexpected RTP payload type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int channels = codec->Channels();
+  int16_t seqDelta = static_cast<int16_t>(h.sequence - lastSeq_);
+  if (haveLast_ && seqDelta <= 0)
+    return Napi::Buffer<char>::New(env, 0); // late or duplicate
+  ++received_;
+
+  recvPcm_.clear();
+  auto decode = [&](const unsigned char *data, size_t len, int maxSamples) {
+    int n = codec->DecodeInto(data, static_cast<opus_int32>(len), outPcm_.data(), maxSamples);
+    if (n > 0)
+      recvPcm_.insert(recvPcm_.end(), outPcm_.begin(), outPcm_.begin() + static_cast<size_t>(n) * channels);
+    return n;
+  };
+  // PLC for `ticks` of missing audio, in chunks outPcm_ can hold and in whole
+  // 2.5 ms steps, the only sizes opus_decode conceals.
+  const int plcStep = codec->Rate() / 400;
+  auto conceal = [&](int32_t ticks) {
+    while (ticks > 0)
+    {
+      int want = std::min(ticks / clockScale_, MAX_FRAME_SIZE);
+      want -= want % plcStep;
+      int n = want > 0 ? decode(nullptr, 0, want) : 0;
+      if (n <= 0)
+        break;
+      ++concealed_;
+      ticks -= n * clockScale_;
+    }
+  };
+
+  // Gap since the last packet, in RTP ticks. Big jumps are a new talkspurt or a
+  // stream reset, not loss; don't try to fill those.
+  int32_t gap = haveLast_ ? static_cast<int32_t>(h.timestamp - nextTs_) : 0;
+  if (gap > 0 && seqDelta > 1 && gap <= 48000)
+  {
+    for (size_t i = 0; i + 1 < blocks.size() && gap > 0; ++i)
+    {
+      uint32_t ts = h.timestamp - blocks[i].timestampOffset;
+      int32_t at = static_cast<int32_t>(ts - nextTs_);
+      if (at < 0 || blocks[i].length == 0)
+        continue; // already played, or nothing to decode
+      if (at > 0) // hole before this copy: conceal it first
+        conceal(at);
+      int n = decode(blocks[i].data, blocks[i].length, MAX_FRAME_SIZE);
+      if (n <= 0)
+        break;
+      ++recovered_;
+      nextTs_ = ts + static_cast<uint32_t>(n * clockScale_);
+      gap = static_cast<int32_t>(h.timestamp - nextTs_);
+    }
+    // Still missing audio
+    conceal(gap);
+  }
+
+  int n = decode(blocks.back().data, blocks.back().length, MAX_FRAME_SIZE);
+  if (n < 0)
+  {
+    Napi::Error::New(env, StrError(n)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  haveLast_ = true;
+  lastSeq_ = h.sequence;
+  nextTs_ = h.timestamp + static_cast<uint32_t>(n * clockScale_);
+  return Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(recvPcm_.data()), recvPcm_.size() * sizeof(opus_int16));
+}
+
+Napi::Value RtpPacketizerWrap::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("received", Napi::Number::New(env, static_cast<double>(received_)));
+  stats.Set("recovered", Napi::Number::New(env, static_cast<double>(recovered_)));
+  stats.Set("concealed", Napi::Number::New(env, static_cast<double>(concealed_)));
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+// RtpPacketizer.parseBatch(packets, info: Int32Array, audioLevelId = 1) -> count
+// Fills 8 slots per packet: payloadOffset, payloadLength (-1 if malformed),
+// sequence, timestamp, ssrc (uint32 bit patterns), payloadType, marker,
+// audioLevel (-1 if absent).
+// -----------------------------------------------------------------------------
+Napi::Value RtpPacketizerWrap::ParseBatch(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsTypedArray() ||
+      info[1].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array)
+  {
+    Napi::TypeError::New(env, "Expected (packets: Buffer[], info: Int32Array, audioLevelId?: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Array packets = info[0].As<Napi::Array>();
+  Napi::Int32Array out = info[1].As<Napi::Int32Array>();
+  int audioLevelId = info.Length() > 2 && info[2].IsNumber() ? info[2].ToNumber().Int32Value() : 1;
+  if (out.ElementLength() < packets.Length() * kBatchStride)
+  {
+    Napi::RangeError::New(env, "info must hold 8 slots per packet").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int32_t *slot = out.Data();
+  uint32_t valid = 0;
+  for (uint32_t i = 0; i < packets.Length(); ++i, slot += kBatchStride)
+  {
+    ByteView view;
+    RtpHeader h;
+    if (!GetByteView(env, packets.Get(i), &view) || !ParseRtp(view.data, view.length, audioLevelId, &h))
+    {
+      slot[0] = 0;
+      slot[1] = -1;
+      continue;
+    }
+    slot[0] = static_cast<int32_t>(h.payloadOffset);
+    slot[1] = static_cast<int32_t>(h.payloadLength);
+    slot[2] = h.sequence;
+    slot[3] = static_cast<int32_t>(h.timestamp);
+    slot[4] = static_cast<int32_t>(h.ssrc);
+    slot[5] = h.payloadType;
+    slot[6] = h.marker;
+    slot[7] = h.audioLevel;
+    ++valid;
+  }
+  return Napi::Number::New(env, valid);
+}
+
+// -----------------------------------------------------------------------------
+// Accessors
+// -----------------------------------------------------------------------------
+Napi::Value RtpPacketizerWrap::GetSequence(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), sequence_);
+}
+
+Napi::Value RtpPacketizerWrap::GetTimestamp(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), timestamp_);
+}
+
+Napi::Value RtpPacketizerWrap::GetSsrc(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), ssrc_);
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object RtpPacketizerWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<RtpPacketizerWrap>::DefineClass(env, "RtpPacketizer", {
+                                                                                                   InstanceMethod("packetize", &RtpPacketizerWrap::Packetize),
+                                                                                                   InstanceMethod("depacketize", &RtpPacketizerWrap::Depacketize),
+                                                                                                   InstanceMethod("stats", &RtpPacketizerWrap::Stats),
+                                                                                                   InstanceAccessor("sequence", &RtpPacketizerWrap::GetSequence, nullptr),
+                                                                                                   InstanceAccessor("timestamp", &RtpPacketizerWrap::GetTimestamp, nullptr),
+                                                                                                   InstanceAccessor("ssrc", &RtpPacketizerWrap::GetSsrc, nullptr),
+                                                                                                   StaticMethod("parseBatch", &RtpPacketizerWrap::ParseBatch),
+                                                                                               });
+  exports.Set("RtpPacketizer", ctor);
+  return exports;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// RTP for Opus (RFC 3550 / RFC 7587).
+// RtpHeader / ParseRtp / WriteRtpHeader are plain helpers; RtpPacketizerWrap
+// encodes straight into the payload slot behind a header it writes itself, and
+// parses + decodes inbound packets without a JS‑side strip.
+// -----------------------------------------------------------------------------
+struct RtpHeader
+{
+  bool marker{false};
+  int payloadType{0};
+  uint16_t sequence{0};
+  uint32_t timestamp{0};
+  uint32_t ssrc{0};
+  int audioLevel{-1}; // RFC 6464 level (0..127), -1 if absent
+  bool voice{false};  // RFC 6464 V flag
+  size_t payloadOffset{0};
+  size_t payloadLength{0};
+};
+
+// Largest header we write: 12 fixed + 4 extension header + 4 audio level element.
+static constexpr size_t kRtpMaxHeader = 20;
+
+// Parses one packet; false if it is not a well‑formed RTP v2 packet.
+bool ParseRtp(const unsigned char *data, size_t len, int audioLevelId, RtpHeader *out);
+
+// Writes the header (with an audio level extension if h.audioLevel >= 0) and
+// returns its size.
+size_t WriteRtpHeader(unsigned char *out, const RtpHeader &h, int audioLevelId);
+
+// RFC 2198 redundant audio: one block per redundant copy plus the primary.
+struct RedBlock
+{
+  int payloadType{0};
+  uint32_t timestampOffset{0}; // primary timestamp minus this block's
+  const unsigned char *data{nullptr};
+  size_t length{0};
+};
+
+static constexpr uint32_t kRedMaxOffset = 0x3fff; // 14‑bit timestamp offset
+static constexpr size_t kRedMaxBlock = 0x3ff;     // 10‑bit block length
+static constexpr int kRedMaxDistance = 3;
+
+// Splits a RED payload into blocks, oldest first and the primary last.
+bool ParseRed(const unsigned char *data, size_t len, std::vector<RedBlock> *blocks);
+
+class RtpPacketizerWrap : public Napi::ObjectWrap<RtpPacketizerWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  RtpPacketizerWrap(const Napi::CallbackInfo &);
+
+private:
+  // JS‑exposed methods
+  Napi::Value Packetize(const Napi::CallbackInfo &);
+  Napi::Value Depacketize(const Napi::CallbackInfo &);
+  Napi::Value GetSequence(const Napi::CallbackInfo &);
+  Napi::Value GetTimestamp(const Napi::CallbackInfo &);
+  Napi::Value GetSsrc(const Napi::CallbackInfo &);
+  Napi::Value Stats(const Napi::CallbackInfo &);
+  static Napi::Value ParseBatch(const Napi::CallbackInfo &);
+
+  // Members
+  Napi::ObjectReference encoderRef_;
+  int payloadType_{111};
+  int audioLevelId_{1};
+  uint32_t ssrc_{0};
+  uint16_t sequence_{0};
+  uint32_t timestamp_{0};
+  int clockScale_{1}; // 48 kHz RTP clock / encoder rate
+  std::vector<unsigned char> packet_; // header + RED headers + redundancy + primary
+  std::vector<opus_int16> inPcm_;
+  std::vector<opus_int16> outPcm_;
+
+  // RED sender: the last `redDistance_` primaries, oldest first.
+  struct Sent
+  {
+    uint32_t timestamp;
+    std::vector<unsigned char> data;
+  };
+  int redPayloadType_{-1}; // -1: RED disabled
+  int redDistance_{1};
+  std::deque<Sent> history_;
+
+  // Receiver: where the last decoded audio ended, for gap recovery.
+  bool haveLast_{false};
+  uint16_t lastSeq_{0};
+  uint32_t nextTs_{0};
+  std::vector<opus_int16> recvPcm_;
+  uint64_t received_{0};
+  uint64_t recovered_{0};
+  uint64_t concealed_{0};
+};
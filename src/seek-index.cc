@@ -0,0 +1,311 @@
+// seek-index.cc – random access into Ogg Opus files via a page table.
+
+#include "seek-index.h"
+#include <algorithm>
+#include <cstring>
+#include "mapped-file.h"
+#include "opus-common.h"
+
+static constexpr int64_t kSeekPreRoll = 3840; // 80 ms @ 48 kHz, RFC 7845 §4.6
+static constexpr uint32_t kSavedVersion = 1;
+static constexpr size_t kSavedHeader = 4 + 4 + 4 + 2 + 1 + 1 + 4 + 8 + 8 + 8 + 4;
+
+// -----------------------------------------------------------------------------
+// Table construction
+// -----------------------------------------------------------------------------
+bool BuildSeekTable(const unsigned char *data, size_t len, SeekTable *table, std::string *error, bool headOnly)
+{
+  table->fileSize = len;
+  table->granules.clear();
+  table->offsets.clear();
+
+  bool haveSerial = false;
+  int headerPackets = 0;
+  bool haveFirstAudio = false;
+  size_t pos = 0;
+  while (pos + 27 <= len)
+  {
+    OggPageInfo page;
+    size_t n = ParseOggPage(data + pos, len - pos, &page, false);
+    if (!n)
+      break; // truncated tail
+    const unsigned char *seg = data + pos + 27;
+    const size_t nseg = data[pos + 26];
+
+    if (!haveSerial)
+    {
+      if (!(page.flags & 0x02) || nseg == 0 || !ParseOpusHead(seg + nseg, std::min<size_t>(n - 27 - nseg, seg[0]), &table->head))
+      {
+        *error = "Stream does not start with a valid OpusHead";
+        return false;
+      }
+      table->serial = page.serial;
+      haveSerial = true;
+    }
+    if (page.serial != table->serial)
+    {
+      pos += n;
+      continue;
+    }
+
+    if (headerPackets >= 2)
+    {
+      if (!haveFirstAudio)
+      {
+        // Start position: first page granule minus the samples it completes.
+        // This is the one payload we touch – just the TOC of each packet.
+        int64_t samples = 0;
+        const unsigned char *body = seg + nseg;
+        size_t start = 0, off = 0;
+        for (size_t i = 0; i < nseg; ++i)
+        {
+          off += seg[i];
+          if (seg[i] == 255)
+            continue;
+          if (off > start && !(start == 0 && (page.flags & 0x01)))
+          {
+            int ns = opus_packet_get_nb_samples(body + start, static_cast<opus_int32>(off - start), 48000);
+            if (ns > 0)
+              samples += ns;
+          }
+          start = off;
+        }
+        table->startGranule = page.granule >= 0 ? std::max<int64_t>(0, page.granule - samples) : 0;
+        table->granules.push_back(table->startGranule);
+        table->offsets.push_back(pos);
+        haveFirstAudio = true;
+        if (headOnly)
+          return true;
+      }
+
+      // Resume point after this page is only usable if no packet spans into
+      // the next page (last lacing value < 255).
+      if (page.granule >= 0 && nseg > 0 && seg[nseg - 1] < 255)
+      {
+        table->granules.push_back(page.granule);
+        table->offsets.push_back(pos + n);
+      }
+      table->endGranule = page.granule >= 0 ? page.granule : table->endGranule;
+    }
+    else
+    {
+      for (size_t i = 0; i < nseg; ++i)
+        if (seg[i] < 255)
+          ++headerPackets;
+    }
+
+    pos += n;
+    if (page.flags & 0x04)
+      break;
+  }
+
+  if (!haveFirstAudio)
+  {
+    *error = "No audio pages found";
+    return false;
+  }
+  return true;
+}
+
+int64_t ReadOggOpusSamples(const unsigned char *data, size_t len)
+{
+  SeekTable head;
+  std::string error;
+  if (!BuildSeekTable(data, len, &head, &error, true))
+    return -1;
+
+  // Walk back from the end to the last complete page of this stream.
+  for (size_t pos = len >= 27 ? len - 27 : 0;; --pos)
+  {
+    if (data[pos] == 'O' && std::memcmp(data + pos, "OggS", 4) == 0)
+    {
+      OggPageInfo page;
+      if (ParseOggPage(data + pos, len - pos, &page) && page.serial == head.serial && page.granule >= 0)
+        return std::max<int64_t>(0, page.granule - head.startGranule - head.head.preSkip);
+    }
+    if (pos == 0)
+      break;
+  }
+  return -1;
+}
+
+// -----------------------------------------------------------------------------
+// Constructor: file path, Ogg Opus buffer, or a buffer from save()
+// -----------------------------------------------------------------------------
+OggSeekIndexWrap::OggSeekIndexWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<OggSeekIndexWrap>(info)
+{
+  Napi::Env env = info.Env();
+  std::string error;
+  if (info.Length() >= 1 && info[0].IsString())
+  {
+    MappedFile file;
+    if (!file.Open(info[0].ToString().Utf8Value()))
+    {
+      Napi::Error::New(env, file.Error()).ThrowAsJavaScriptException();
+      return;
+    }
+    if (!BuildSeekTable(file.Data(), file.Size(), &table_, &error))
+    {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return;
+    }
+  }
+  else if (info.Length() >= 1 && info[0].IsBuffer())
+  {
+    Napi::Buffer<unsigned char> buf = info[0].As<Napi::Buffer<unsigned char>>();
+    if (buf.Length() >= 4 && std::memcmp(buf.Data(), "OSIX", 4) == 0)
+    {
+      if (!Load(buf.Data(), buf.Length()))
+        Napi::Error::New(env, "Invalid or unsupported saved seek index").ThrowAsJavaScriptException();
+    }
+    else if (!BuildSeekTable(buf.Data(), buf.Length(), &table_, &error))
+    {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    }
+  }
+  else
+  {
+    Napi::TypeError::New(env, "Expected (path: string) or (data: Buffer)").ThrowAsJavaScriptException();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Seek: resume offset plus samples to discard after decoding from there
+// -----------------------------------------------------------------------------
+Napi::Value OggSeekIndexWrap::Seek(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (positionMs: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  double ms = std::max(0.0, info[0].ToNumber().DoubleValue());
+  int64_t target = table_.startGranule + table_.head.preSkip + static_cast<int64_t>(ms * 48.0);
+  target = std::min(target, std::max(table_.endGranule, table_.startGranule));
+
+  // Last resume point at least one pre‑roll before the target.
+  auto it = std::upper_bound(table_.granules.begin(), table_.granules.end(), target - kSeekPreRoll);
+  size_t idx = it == table_.granules.begin() ? 0 : static_cast<size_t>(it - table_.granules.begin()) - 1;
+  // Resuming after the final page would give the decoder nothing to read.
+  while (idx > 0 && table_.offsets[idx] >= table_.fileSize)
+    --idx;
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("offset", Napi::Number::New(env, static_cast<double>(table_.offsets[idx])));
+  result.Set("granule", Napi::Number::New(env, static_cast<double>(table_.granules[idx])));
+  result.Set("preRoll", Napi::Number::New(env, static_cast<double>(target - table_.granules[idx])));
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Persistence: "OSIX" header followed by (granule, offset) pairs, all LE
+// -----------------------------------------------------------------------------
+Napi::Value OggSeekIndexWrap::Save(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  size_t count = table_.granules.size();
+  Napi::Buffer<unsigned char> out = Napi::Buffer<unsigned char>::New(env, kSavedHeader + count * 16);
+  unsigned char *p = out.Data();
+
+  std::memcpy(p, "OSIX", 4);
+  PutLE32(p + 4, kSavedVersion);
+  PutLE32(p + 8, table_.serial);
+  PutLE16(p + 12, table_.head.preSkip);
+  p[14] = static_cast<unsigned char>(table_.head.channels);
+  p[15] = static_cast<unsigned char>(table_.head.mappingFamily);
+  PutLE32(p + 16, table_.head.inputRate);
+  PutLE64(p + 20, static_cast<uint64_t>(table_.startGranule));
+  PutLE64(p + 28, static_cast<uint64_t>(table_.endGranule));
+  PutLE64(p + 36, table_.fileSize);
+  PutLE32(p + 44, static_cast<uint32_t>(count));
+  p += kSavedHeader;
+  for (size_t i = 0; i < count; ++i, p += 16)
+  {
+    PutLE64(p, static_cast<uint64_t>(table_.granules[i]));
+    PutLE64(p + 8, table_.offsets[i]);
+  }
+  return out;
+}
+
+bool OggSeekIndexWrap::Load(const unsigned char *data, size_t len)
+{
+  if (len < kSavedHeader || GetLE32(data + 4) != kSavedVersion)
+    return false;
+  size_t count = GetLE32(data + 44);
+  if (count == 0 || len < kSavedHeader + count * 16)
+    return false;
+
+  table_.serial = GetLE32(data + 8);
+  table_.head.preSkip = GetLE16(data + 12);
+  table_.head.channels = data[14];
+  table_.head.mappingFamily = data[15];
+  table_.head.inputRate = GetLE32(data + 16);
+  table_.startGranule = static_cast<int64_t>(GetLE64(data + 20));
+  table_.endGranule = static_cast<int64_t>(GetLE64(data + 28));
+  table_.fileSize = GetLE64(data + 36);
+  table_.granules.resize(count);
+  table_.offsets.resize(count);
+  const unsigned char *p = data + kSavedHeader;
+  for (size_t i = 0; i < count; ++i, p += 16)
+  {
+    table_.granules[i] = static_cast<int64_t>(GetLE64(p));
+    table_.offsets[i] = GetLE64(p + 8);
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Accessors
+// -----------------------------------------------------------------------------
+Napi::Value OggSeekIndexWrap::GetDuration(const Napi::CallbackInfo &info)
+{
+  int64_t samples = std::max<int64_t>(0, table_.endGranule - table_.startGranule - table_.head.preSkip);
+  return Napi::Number::New(info.Env(), samples / 48.0);
+}
+
+Napi::Value OggSeekIndexWrap::GetPageCount(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), static_cast<double>(table_.granules.size()));
+}
+
+Napi::Value GetOggOpusDuration(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString())
+  {
+    Napi::TypeError::New(env, "Expected (path: string)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  MappedFile file;
+  if (!file.Open(info[0].ToString().Utf8Value()))
+  {
+    Napi::Error::New(env, file.Error()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int64_t samples = ReadOggOpusSamples(file.Data(), file.Size());
+  if (samples < 0)
+  {
+    Napi::Error::New(env, "Not an Ogg Opus file").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Number::New(env, samples / 48.0);
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object OggSeekIndexWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<OggSeekIndexWrap>::DefineClass(env, "OggSeekIndex", {
+                                                                                                 InstanceMethod("seek", &OggSeekIndexWrap::Seek),
+                                                                                                 InstanceMethod("save", &OggSeekIndexWrap::Save),
+                                                                                                 InstanceAccessor("duration", &OggSeekIndexWrap::GetDuration, nullptr),
+                                                                                                 InstanceAccessor("pageCount", &OggSeekIndexWrap::GetPageCount, nullptr),
+                                                                                             });
+  exports.Set("OggSeekIndex", ctor);
+  exports.Set("getOggOpusDuration", Napi::Function::New(env, GetOggOpusDuration, "getOggOpusDuration"));
+  return exports;
+}
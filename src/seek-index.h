@@ -0,0 +1,54 @@
+#pragma once
+
+#include <napi.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ogg-opus.h"
+
+// -----------------------------------------------------------------------------
+// SeekTable – granule position -> resume offset for one Ogg Opus stream.
+// Entry i says: start reading at offsets[i] and the first packet decoded
+// begins at 48 kHz granule granules[i]. Entry 0 is the first audio page.
+// -----------------------------------------------------------------------------
+struct SeekTable
+{
+  uint32_t serial{0};
+  OpusHeadInfo head;
+  int64_t startGranule{0};
+  int64_t endGranule{0};
+  uint64_t fileSize{0};
+  std::vector<int64_t> granules;
+  std::vector<uint64_t> offsets;
+};
+
+// Scans page headers only (payloads are skipped, except the TOC bytes of the
+// first audio page). With headOnly, stops once the start position is known.
+// Returns false and sets *error on malformed input.
+bool BuildSeekTable(const unsigned char *data, size_t len, SeekTable *table, std::string *error, bool headOnly = false);
+
+// Duration in 48 kHz samples from the first pages and the last page only;
+// -1 if it cannot be found.
+int64_t ReadOggOpusSamples(const unsigned char *data, size_t len);
+
+class OggSeekIndexWrap : public Napi::ObjectWrap<OggSeekIndexWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  OggSeekIndexWrap(const Napi::CallbackInfo &);
+
+private:
+  // JS‑exposed methods
+  Napi::Value Seek(const Napi::CallbackInfo &);
+  Napi::Value Save(const Napi::CallbackInfo &);
+  Napi::Value GetDuration(const Napi::CallbackInfo &);
+  Napi::Value GetPageCount(const Napi::CallbackInfo &);
+
+  // Helpers
+  bool Load(const unsigned char *data, size_t len);
+
+  SeekTable table_;
+};
+
+// getOggOpusDuration(path) -> milliseconds, reading the header and last page.
+Napi::Value GetOggOpusDuration(const Napi::CallbackInfo &info);
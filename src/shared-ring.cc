@@ -0,0 +1,393 @@
+// shared-ring.cc – SharedArrayBuffer rings and the ring‑fed encoder thread.
+
+#include "shared-ring.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// SpscRing
+// -----------------------------------------------------------------------------
+static uint32_t Align4(uint32_t n)
+{
+  return (n + 3) & ~3u;
+}
+
+bool SpscRing::Attach(unsigned char *mem, size_t len)
+{
+  static_assert(sizeof(std::atomic<uint32_t>) == 4 && std::atomic<uint32_t>::is_always_lock_free,
+                "ring indices must be plain lock‑free 32‑bit words");
+  if (!mem || reinterpret_cast<uintptr_t>(mem) % 4 != 0 || len < kHeader + 64)
+    return false;
+
+  writeIdx_ = reinterpret_cast<std::atomic<uint32_t> *>(mem);
+  readIdx_ = reinterpret_cast<std::atomic<uint32_t> *>(mem + 64);
+  std::atomic<uint32_t> *cap = reinterpret_cast<std::atomic<uint32_t> *>(mem + 128);
+  data_ = mem + kHeader;
+
+  uint32_t c = cap->load(std::memory_order_acquire);
+  if (c == 0)
+  {
+    size_t avail = len - kHeader;
+    c = 64;
+    while (static_cast<size_t>(c) * 2 <= avail && c < (1u << 30))
+      c *= 2;
+    writeIdx_->store(0, std::memory_order_relaxed);
+    readIdx_->store(0, std::memory_order_relaxed);
+    cap->store(c, std::memory_order_release);
+  }
+  if ((c & (c - 1)) != 0 || kHeader + static_cast<size_t>(c) > len)
+    return false;
+  capacity_ = c;
+  return true;
+}
+
+uint32_t SpscRing::Used() const
+{
+  return writeIdx_->load(std::memory_order_acquire) - readIdx_->load(std::memory_order_acquire);
+}
+
+bool SpscRing::Write(const void *data, uint32_t len)
+{
+  const uint32_t need = 4 + Align4(len);
+  if (len >= capacity_ || need > capacity_)
+    return false;
+
+  uint32_t w = writeIdx_->load(std::memory_order_relaxed);
+  uint32_t r = readIdx_->load(std::memory_order_acquire);
+  uint32_t pos = w & (capacity_ - 1);
+  uint32_t tail = capacity_ - pos;
+  uint32_t total = need > tail ? tail + need : need;
+  if (pos % 4 != 0 || w - r > capacity_ || (w - r) + total > capacity_)
+    return false; // full, or indices scribbled on from JS
+
+  if (need > tail)
+  {
+    std::memcpy(data_ + pos, &kPad, 4); // tail is a multiple of 4
+    w += tail;
+    pos = 0;
+  }
+  std::memcpy(data_ + pos, &len, 4);
+  std::memcpy(data_ + pos + 4, data, len);
+  writeIdx_->store(w + need, std::memory_order_release);
+  return true;
+}
+
+bool SpscRing::Peek(const unsigned char **data, uint32_t *len)
+{
+  // Everything below comes from memory JS can write, so each record must fit
+  // both in what was produced and, contiguously, before the end of the data.
+  corrupt_ = false;
+  uint32_t r = readIdx_->load(std::memory_order_relaxed);
+  for (;;)
+  {
+    uint32_t w = writeIdx_->load(std::memory_order_acquire);
+    if (r == w)
+      return false;
+    uint32_t avail = w - r;
+    uint32_t pos = r & (capacity_ - 1);
+    uint32_t tail = capacity_ - pos;
+    if (avail > capacity_ || avail < 4 || pos % 4 != 0)
+    {
+      corrupt_ = true;
+      return false;
+    }
+    uint32_t l;
+    std::memcpy(&l, data_ + pos, 4);
+    if (l == kPad)
+    {
+      if (tail > avail)
+      {
+        corrupt_ = true;
+        return false;
+      }
+      r += tail;
+      readIdx_->store(r, std::memory_order_release);
+      continue;
+    }
+    if (l > tail - 4 || 4 + Align4(l) > std::min(tail, avail))
+    {
+      corrupt_ = true;
+      return false;
+    }
+    *data = data_ + pos + 4;
+    *len = l;
+    pending_ = 4 + Align4(l);
+    return true;
+  }
+}
+
+void SpscRing::Consume()
+{
+  uint32_t r = readIdx_->load(std::memory_order_relaxed);
+  readIdx_->store(r + pending_, std::memory_order_release);
+  pending_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// PcmRing (JS)
+// -----------------------------------------------------------------------------
+bool PcmRingWrap::AttachView(Napi::Env env, Napi::Value value, SpscRing *ring)
+{
+  if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array)
+  {
+    Napi::TypeError::New(env, "Expected a Uint8Array over a SharedArrayBuffer").ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Uint8Array view = value.As<Napi::Uint8Array>();
+  if (!ring->Attach(view.Data(), view.ByteLength()))
+  {
+    Napi::RangeError::New(env, "Ring view is too small, misaligned or has a corrupt header").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
+}
+
+PcmRingWrap::PcmRingWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<PcmRingWrap>(info)
+{
+  if (info.Length() < 1 || !AttachView(info.Env(), info[0], &ring_))
+    return;
+  viewRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+}
+
+Napi::Value PcmRingWrap::ByteLength(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (capacity: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // Round the data area up to a power of two, as Attach() will use.
+  double want = info[0].ToNumber().DoubleValue();
+  double cap = 64;
+  while (cap < want && cap < (1u << 30))
+    cap *= 2;
+  return Napi::Number::New(env, SpscRing::kHeader + cap);
+}
+
+Napi::Value PcmRingWrap::Write(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsTypedArray())
+  {
+    Napi::TypeError::New(env, "Argument must be a Buffer or TypedArray").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // napi_get_typedarray_info also works for views over SharedArrayBuffers.
+  Napi::TypedArray src = info[0].As<Napi::TypedArray>();
+  void *bytes = nullptr;
+  napi_get_typedarray_info(env, src, nullptr, nullptr, &bytes, nullptr, nullptr);
+  return Napi::Boolean::New(env, ring_.Write(bytes, static_cast<uint32_t>(src.ByteLength())));
+}
+
+Napi::Value PcmRingWrap::Read(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  const unsigned char *data;
+  uint32_t len;
+  if (!ring_.Peek(&data, &len))
+  {
+    if (ring_.Corrupt())
+      Napi::Error::New(env, "Ring is corrupt: record length or indices out of range").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Buffer<char> out = Napi::Buffer<char>::Copy(env, reinterpret_cast<const char *>(data), len);
+  ring_.Consume();
+  return out;
+}
+
+Napi::Value PcmRingWrap::GetUsed(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), ring_.Used());
+}
+
+Napi::Value PcmRingWrap::GetCapacity(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), ring_.Capacity());
+}
+
+Napi::Object PcmRingWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<PcmRingWrap>::DefineClass(env, "PcmRing", {
+                                                                                       StaticMethod("byteLength", &PcmRingWrap::ByteLength),
+                                                                                       InstanceMethod("write", &PcmRingWrap::Write),
+                                                                                       InstanceMethod("read", &PcmRingWrap::Read),
+                                                                                       InstanceAccessor("used", &PcmRingWrap::GetUsed, nullptr),
+                                                                                       InstanceAccessor("capacity", &PcmRingWrap::GetCapacity, nullptr),
+                                                                                   });
+  exports.Set("PcmRing", ctor);
+  return exports;
+}
+
+// -----------------------------------------------------------------------------
+// RingEncoder: new RingEncoder(rate, channels, input, output)
+// -----------------------------------------------------------------------------
+RingEncoderWrap::RingEncoderWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<RingEncoderWrap>(info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 4 || !info[0].IsNumber() || !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (rate: number, channels: number, input: Uint8Array, output: Uint8Array)").ThrowAsJavaScriptException();
+    return;
+  }
+  rate_ = info[0].ToNumber().Int32Value();
+  channels_ = info[1].ToNumber().Int32Value();
+  if (!PcmRingWrap::AttachView(env, info[2], &input_) || !PcmRingWrap::AttachView(env, info[3], &output_))
+    return;
+  inputRef_ = Napi::Persistent(info[2].As<Napi::Object>());
+  outputRef_ = Napi::Persistent(info[3].As<Napi::Object>());
+
+  int err;
+  enc_ = opus_encoder_create(rate_, channels_, OPUS_APPLICATION_AUDIO, &err);
+  if (err != OPUS_OK)
+  {
+    enc_ = nullptr;
+    Napi::Error::New(env, "Failed to create libopus encoder (bad params?)").ThrowAsJavaScriptException();
+  }
+}
+
+RingEncoderWrap::~RingEncoderWrap()
+{
+  Join();
+  if (enc_)
+    opus_encoder_destroy(enc_);
+}
+
+void RingEncoderWrap::Join()
+{
+  running_.store(false);
+  if (thread_.joinable())
+    thread_.join();
+}
+
+// Spin briefly, then back off to short sleeps while the rings are idle/full.
+static void Backoff(unsigned *idle)
+{
+  if (++*idle < 64)
+    std::this_thread::yield();
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(*idle < 256 ? 100 : 1000));
+}
+
+void RingEncoderWrap::Loop()
+{
+  unsigned char packet[MAX_PACKET_SIZE];
+  unsigned idle = 0;
+  while (running_.load(std::memory_order_relaxed))
+  {
+    const unsigned char *pcm;
+    uint32_t len;
+    if (!input_.Peek(&pcm, &len))
+    {
+      // A corrupt ring is not consumed any further; stats() reports it.
+      if (input_.Corrupt() && !corrupt_.exchange(true))
+        ++errors_;
+      Backoff(&idle);
+      continue;
+    }
+    idle = 0;
+
+    int frameSize = static_cast<int>(len / 2 / channels_);
+    if (len % (2 * channels_) != 0 || frameSize > MAX_FRAME_SIZE)
+    {
+      ++errors_;
+      input_.Consume();
+      continue;
+    }
+
+    // The record is 4‑byte aligned inside the ring, so it can be read in place.
+    int clen = opus_encode(enc_, reinterpret_cast<const opus_int16 *>(pcm), frameSize, packet, MAX_PACKET_SIZE);
+    input_.Consume();
+    if (clen < 0)
+    {
+      ++errors_;
+      continue;
+    }
+
+    // Backpressure: wait for the consumer rather than dropping packets.
+    unsigned full = 0;
+    while (!output_.Write(packet, static_cast<uint32_t>(clen)))
+    {
+      if (full++ == 0)
+        ++stalls_;
+      if (!running_.load(std::memory_order_relaxed))
+        return;
+      Backoff(&full);
+    }
+    ++frames_;
+  }
+}
+
+Napi::Value RingEncoderWrap::Start(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!enc_)
+  {
+    Napi::Error::New(env, "Encoder not initialised").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!running_.exchange(true))
+  {
+    if (thread_.joinable())
+      thread_.join();
+    thread_ = std::thread(&RingEncoderWrap::Loop, this);
+    Ref(); // stay alive while the thread touches our members
+  }
+  return env.Undefined();
+}
+
+Napi::Value RingEncoderWrap::Stop(const Napi::CallbackInfo &info)
+{
+  bool wasRunning = thread_.joinable() && running_.load();
+  Join();
+  if (wasRunning)
+    Unref();
+  return info.Env().Undefined();
+}
+
+Napi::Value RingEncoderWrap::ApplyEncoderCTL(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (ctl: number, value: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!enc_ || running_.load())
+  {
+    Napi::Error::New(env, "Encoder must be stopped to apply CTLs").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int rc = opus_encoder_ctl(enc_, info[0].ToNumber().Int32Value(), info[1].ToNumber().Int32Value());
+  if (rc != OPUS_OK)
+  {
+    Napi::Error::New(env, StrError(rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Number::New(env, rc);
+}
+
+Napi::Value RingEncoderWrap::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("running", Napi::Boolean::New(env, running_.load()));
+  stats.Set("frames", Napi::Number::New(env, static_cast<double>(frames_.load())));
+  stats.Set("errors", Napi::Number::New(env, static_cast<double>(errors_.load())));
+  stats.Set("outputStalls", Napi::Number::New(env, static_cast<double>(stalls_.load())));
+  stats.Set("inputCorrupt", Napi::Boolean::New(env, corrupt_.load()));
+  return stats;
+}
+
+Napi::Object RingEncoderWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<RingEncoderWrap>::DefineClass(env, "RingEncoder", {
+                                                                                               InstanceMethod("start", &RingEncoderWrap::Start),
+                                                                                               InstanceMethod("stop", &RingEncoderWrap::Stop),
+                                                                                               InstanceMethod("applyEncoderCTL", &RingEncoderWrap::ApplyEncoderCTL),
+                                                                                               InstanceMethod("stats", &RingEncoderWrap::Stats),
+                                                                                           });
+  exports.Set("RingEncoder", ctor);
+  return exports;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include "opus-common.h"
+
+// -----------------------------------------------------------------------------
+// SpscRing – single‑producer / single‑consumer ring of length‑prefixed records
+// living in caller‑provided shared memory (a SharedArrayBuffer), so a
+// worker_thread and a native thread can exchange frames without copies
+// through postMessage.
+//
+// Layout (little‑endian, offsets in bytes):
+//   0    write index (u32, total bytes produced, wraps)
+//   64   read index  (u32, total bytes consumed, wraps)
+//   128  capacity    (u32, power of two)
+//   192  data[capacity]
+// Each record is a u32 length followed by the payload, padded to 4 bytes;
+// a length of 0xffffffff marks padding up to the end of the buffer so records
+// are always contiguous.
+// -----------------------------------------------------------------------------
+class SpscRing
+{
+public:
+  static constexpr size_t kHeader = 192;
+  static constexpr uint32_t kPad = 0xffffffffu;
+
+  // Attaches to `mem`; initialises the header if capacity is still zero.
+  bool Attach(unsigned char *mem, size_t len);
+
+  // Producer side. Returns false if the record does not fit right now.
+  bool Write(const void *data, uint32_t len);
+
+  // Consumer side: look at the oldest record, then release it. Peek() also
+  // returns false when the indices or the record header are out of range
+  // (the shared memory was scribbled on); Corrupt() then says so.
+  bool Peek(const unsigned char **data, uint32_t *len);
+  void Consume();
+  bool Corrupt() const { return corrupt_; }
+
+  uint32_t Capacity() const { return capacity_; }
+  uint32_t Used() const;
+
+private:
+  std::atomic<uint32_t> *writeIdx_{nullptr};
+  std::atomic<uint32_t> *readIdx_{nullptr};
+  unsigned char *data_{nullptr};
+  uint32_t capacity_{0};
+  uint32_t pending_{0}; // size of the record returned by the last Peek
+  bool corrupt_{false};  // set by the last Peek
+};
+
+// JS view over a ring: new PcmRing(view: Uint8Array over a SharedArrayBuffer)
+class PcmRingWrap : public Napi::ObjectWrap<PcmRingWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  PcmRingWrap(const Napi::CallbackInfo &);
+
+  // Validates `value` as a shared Uint8Array and attaches `ring` to it.
+  static bool AttachView(Napi::Env env, Napi::Value value, SpscRing *ring);
+
+private:
+  // JS‑exposed methods
+  static Napi::Value ByteLength(const Napi::CallbackInfo &);
+  Napi::Value Write(const Napi::CallbackInfo &);
+  Napi::Value Read(const Napi::CallbackInfo &);
+  Napi::Value GetUsed(const Napi::CallbackInfo &);
+  Napi::Value GetCapacity(const Napi::CallbackInfo &);
+
+  SpscRing ring_;
+  Napi::ObjectReference viewRef_;
+};
+
+// -----------------------------------------------------------------------------
+// RingEncoder – native thread that consumes PCM frames from one ring, encodes
+// them and produces Opus packets into another ring.
+// -----------------------------------------------------------------------------
+class RingEncoderWrap : public Napi::ObjectWrap<RingEncoderWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  RingEncoderWrap(const Napi::CallbackInfo &);
+  ~RingEncoderWrap();
+
+private:
+  // JS‑exposed methods
+  Napi::Value Start(const Napi::CallbackInfo &);
+  Napi::Value Stop(const Napi::CallbackInfo &);
+  Napi::Value ApplyEncoderCTL(const Napi::CallbackInfo &);
+  Napi::Value Stats(const Napi::CallbackInfo &);
+
+  void Loop();
+  void Join();
+
+  opus_int32 rate_{0};
+  int channels_{0};
+  OpusEncoder *enc_{nullptr};
+  SpscRing input_;
+  SpscRing output_;
+  Napi::ObjectReference inputRef_;
+  Napi::ObjectReference outputRef_;
+
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<uint64_t> errors_{0};
+  std::atomic<uint64_t> stalls_{0}; // output ring full
+  std::atomic<bool> corrupt_{false}; // input ring failed validation
+};
@@ -1,7 +1,33 @@
 import assert from 'node:assert';
+import { execFileSync } from 'node:child_process';
+import { once } from 'node:events';
 import fs from 'node:fs';
+import os from 'node:os';
 import path from 'node:path';
-import { OpusEncoder } from '../../dist/index.js';
+import { pathToFileURL } from 'node:url';
+import { Worker } from 'node:worker_threads';
+import {
+  ClipCache,
+  CodecPool,
+  EncoderFarm,
+  FrameInfo,
+  LadderEncoder,
+  OggRecorder,
+  OggSeekIndex,
+  OpusCustomEncoder,
+  OpusEncoder,
+  PcmIngest,
+  PcmRing,
+  RateController,
+  RtpPacketizer,
+  UdpTransport,
+  concatOggOpus,
+  customModes,
+  cutOggOpus,
+  decodeFileParallel,
+  dnn,
+  encodeFileParallel,
+} from '../../dist/index.js';
 
 const opus = new OpusEncoder(16_000, 1);
 
@@ -10,4 +36,245 @@ const frame = fs.readFileSync(path.join(import.meta.dirname, 'frame.opus'));
 const decoded = opus.decode(frame);
 
 assert(decoded.length === 640, 'Decoded frame length is not 640');
+opus.setSilenceDetection({ hangoverFrames: 2, mode: 'skip' });
+const gated = [0, 1, 2, 3].map(() => opus.encode(Buffer.alloc(320 * 2)));
+assert(gated[1].length > 0 && gated[2].length === 0, 'Silence gate did not bypass after the hangover');
+assert(opus.getSilenceStats().bypassedFrames === 2, 'Silence gate counted the wrong number of frames');
+assert(opus.encode(Buffer.alloc(320 * 2, 0x40)).length > 1, 'Silence gate did not reopen on sound');
+opus.setSilenceDetection(false);
+
+// 40 ms CELT frames are two-frame packets; bypassed ones must still decode to 40 ms.
+const celt = new OpusEncoder(48_000, 1, { application: 'lowdelay' });
+celt.setSilenceDetection({ hangoverFrames: 1, refreshFrames: 100 });
+const celtDtx = [0, 1, 2, 3].map(() => celt.encode(Buffer.alloc(1920 * 2)));
+assert(celt.getSilenceStats().bypassedFrames === 3, 'Silence gate did not bypass 40 ms frames');
+const celtDecoder = new OpusEncoder(48_000, 1);
+for (const p of celtDtx) assert(celtDecoder.decode(p).length === 1920 * 2, 'Bypassed 40 ms frame decoded to the wrong length');
+
+const withAnalysis = opus.encodeWithAnalysis(Buffer.alloc(320 * 2));
+assert(withAnalysis.packet.length > 0 && typeof withAnalysis.analysis.vad === 'number', 'encodeWithAnalysis returned no analysis');
+assert(typeof opus.analyze(Buffer.alloc(320 * 2)).music === 'number', 'analyze returned no music probability');
+
+const viewPacket = opus.encode(new Int16Array(320));
+assert(viewPacket.length > 0, 'encode rejected an Int16Array');
+const oddView = new Uint8Array(new ArrayBuffer(641), 1, 640);
+assert(opus.encode(oddView).length > 0, 'encode rejected an odd-offset view');
+assert(opus.decode(new Uint8Array(viewPacket)).length === 640, 'decode rejected a Uint8Array');
+
+opus.setTimeBudget({ budgetUs: 1e6, windowFrames: 2 });
+opus.encode(Buffer.alloc(320 * 2));
+opus.encode(Buffer.alloc(320 * 2));
+assert(opus.getTimeBudgetStats().frames === 2, 'Time budget did not record encodes');
+assert.throws(() => opus.setTimeBudget(true), TypeError);
+const capped = new OpusEncoder(48_000, 1);
+capped.applyEncoderCTL(4004, 1101); // OPUS_SET_MAX_BANDWIDTH, narrowband
+capped.setTimeBudget({ budgetUs: 1e6 });
+const cappedInfo = new Int32Array(FrameInfo.length);
+const noise = Int16Array.from({ length: 960 }, () => (Math.random() - 0.5) * 20_000);
+for (let i = 0; i < 5; i++) capped.encodeWithInfo(noise, cappedInfo);
+assert(cappedInfo[FrameInfo.BANDWIDTH] === 1101, 'Time budget overrode the max bandwidth');
+opus.setTimeBudget(false);
+assert(opus.getTimeBudgetStats() === null, 'setTimeBudget(false) did not detach');
+
+const sim = RateController.simulate({ maxBitrate: 64_000 }, [
+  ...Array(20).fill({ capacityKbps: 80 }),
+  ...Array(20).fill({ capacityKbps: 20 }),
+]);
+assert(sim[19].bitrate === 64_000 && sim[39].bitrate < 30_000, 'RateController did not follow the bottleneck');
+assert(sim.some((d) => d.fec), 'RateController never enabled FEC under loss');
+const probe = (rttMs) => RateController.simulate({ maxBitrate: 64_000 }, Array(8).fill({ loss: 0, rttMs }))[7].bitrate;
+assert(probe(1500) < probe(20), 'RateController probed faster than the RTT');
+assert.throws(() => new RateController(opus, { minBitrate: 8000, maxBitrate: 32_000, startBitrate: 64_000 }), RangeError);
+const rc = new RateController(opus, { minBitrate: 8000, maxBitrate: 32_000 });
+assert(rc.report({ loss: 0.3, nowMs: 0 }).fec && opus.getBitrate() <= 32_000, 'RateController did not apply its decision');
+
+const rtp = new RtpPacketizer(opus, { ssrc: 7, sequence: 65_535, timestamp: 0 });
+const rtpPacket = rtp.packetize(Buffer.alloc(320 * 2), { audioLevel: 20 });
+assert(rtpPacket[0] === 0x90 && rtpPacket.readUInt32BE(8) === 7, 'RtpPacketizer wrote a bad header');
+assert(rtp.sequence === 0 && rtp.timestamp === 960, 'RtpPacketizer did not advance sequence/timestamp at 48 kHz');
+assert(rtp.depacketize(rtpPacket).length === 640, 'RtpPacketizer did not decode its own packet');
+const rtpInfo = new Int32Array(16);
+assert(RtpPacketizer.parseBatch([rtpPacket, Buffer.alloc(3)], rtpInfo) === 1, 'parseBatch accepted a runt');
+assert(rtpInfo[0] === 20 && rtpInfo[7] === 20 && rtpInfo[9] === -1, 'parseBatch filled the wrong slots');
+const red = new RtpPacketizer(opus, { red: { payloadType: 63 } });
+const redPackets = [0, 1, 2].map((i) => red.packetize(Buffer.alloc(320 * 2, i)));
+assert((redPackets[1][1] & 0x7f) === 63, 'RED packet has the wrong payload type');
+red.depacketize(redPackets[0]);
+assert(red.depacketize(redPackets[2]).length === 2 * 640, 'RED did not recover the lost frame');
+assert(red.stats().recovered === 1 && red.stats().concealed === 0, 'RED recovery was not counted');
+// A sender-chosen 1 s gap and maximum RED offset must be concealed in
+// decoder-sized chunks, not in one oversized PLC call.
+const farRed = new RtpPacketizer(opus, { red: { payloadType: 63 }, sequence: 100, timestamp: 0 });
+farRed.depacketize(farRed.packetize(Buffer.alloc(320 * 2)));
+const far = Buffer.from(farRed.packetize(Buffer.alloc(320 * 2, 1)));
+far.writeUInt16BE(102, 2);
+far.writeUInt32BE(960 + 48_000, 4);
+far[13] = 0xff; // RED block offset = 0x3fff
+far[14] |= 0xfc;
+const farPcm = farRed.depacketize(far);
+assert(farPcm.length > 2 * 15_000 && farPcm.length <= 2 * (16_000 + 320), 'RED gap was not concealed');
+assert(farRed.stats().recovered === 1 && farRed.stats().concealed > 1, 'RED gap concealment was not counted');
+
+if (process.platform === 'linux') {
+  const rx = new UdpTransport({ address: '127.0.0.1' });
+  const tx = new UdpTransport({ address: '127.0.0.1' });
+  const peer = tx.addPeer('127.0.0.1', rx.port);
+  const sender = new RtpPacketizer(opus, { sequence: 10 });
+  for (let i = 0; i < 3; i++) tx.queue(sender.packetize(Buffer.alloc(320 * 2, i)), peer);
+  assert(tx.flush() === 3 && tx.stats().sendCalls === 1, 'UdpTransport did not batch the sends');
+  const samples = new Int32Array(8);
+  assert(rx.receiveDecode(opus, Buffer.alloc(8 * 640), samples, { maxPackets: 8 }) === 3, 'UdpTransport lost packets on loopback');
+  assert(samples[0] === 320 && samples[2] === 320, 'UdpTransport did not decode what it received');
+  rx.close();
+  tx.close();
+}
+
+const frameInfo = new Int32Array(FrameInfo.length);
+assert.throws(() => opus.encodeWithInfo(Buffer.alloc(0), frameInfo), RangeError);
+assert.throws(() => opus.encode(Buffer.alloc(0)), RangeError);
+const infoPacket = opus.encodeWithInfo(Buffer.alloc(320 * 2, 0x11), frameInfo);
+assert(
+  frameInfo[FrameInfo.BYTES] === infoPacket.length && frameInfo[FrameInfo.FRAME_SIZE] === 320,
+  'encodeWithInfo wrote the wrong metadata',
+);
+
+const cache = new ClipCache();
+const clip = Buffer.alloc(16_000, 0x20);
+const fresh = cache.encode(opus, clip);
+opus.encode(Buffer.alloc(320 * 2, 0x55)); // encoder history must not change the key
+const cached = cache.encode(opus, clip);
+assert(fresh.length === 25 && cached.every((p, i) => p.equals(fresh[i])), 'ClipCache hit differs from a fresh encode');
+assert(cache.stats().hits === 1 && cache.stats().misses === 1, 'ClipCache did not count the hit');
+const noPrediction = new OpusEncoder(16_000, 1);
+noPrediction.applyEncoderCTL(4042, 1); // OPUS_SET_PREDICTION_DISABLED
+cache.encode(noPrediction, clip);
+assert(cache.stats().misses === 2, 'ClipCache shared packets across different prediction settings');
+
+const ladder = new LadderEncoder(48_000, 2, [24_000, 64_000, 128_000]);
+const packets = ladder.encode(Buffer.alloc(960 * 2 * 2));
+assert(packets.length === 3, 'Ladder did not return one packet per rung');
+assert(packets.every((p) => p.length > 0), 'Ladder returned an empty packet');
+
+const ogg = await encodeFileParallel(Buffer.alloc(48_000 * 2 * 3), 48_000, 1, { segmentSeconds: 1 });
+assert(ogg.subarray(0, 4).toString() === 'OggS', 'Parallel encode did not produce an Ogg stream');
+
+const roundTrip = await decodeFileParallel(ogg, { segmentSeconds: 1 });
+assert(roundTrip.samples === 48_000 * 3, 'Parallel decode did not restore the input length');
+assert.throws(() => encodeFileParallel(Buffer.alloc(4000 * 2), 4000, 1), RangeError);
+assert.throws(() => decodeFileParallel(ogg, { rate: 3000 }), RangeError);
+
+const cut = cutOggOpus(ogg, 1000, 2000);
+assert(new OggSeekIndex(cut).duration === 1000, 'Cut did not trim to the requested range');
+// Inner joins must sit on packet boundaries: 20 ms packets, offset by pre-skip.
+const boundaryMs = (k) => k * 20 - ogg.readUInt16LE(ogg.indexOf('OpusHead') + 10) / 48;
+const ranges = [[500, boundaryMs(65)], [boundaryMs(40), boundaryMs(75)], [boundaryMs(100), 2512.5]];
+const joined = concatOggOpus(ranges.map(([startMs, endMs]) => ({ source: ogg, startMs, endMs })));
+const joinedMs = new OggSeekIndex(joined).duration;
+assert(Math.abs(joinedMs - ranges.reduce((sum, [a, b]) => sum + b - a, 0)) < 1e-6, 'Concat did not keep exactly the requested ranges');
+assert.throws(() => concatOggOpus([cut, { source: ogg, startMs: 1000 }]), /packet boundary/, 'Concat accepted a sub-packet inner join');
+assert((await decodeFileParallel(joined)).samples === Math.round(joinedMs * 48), 'Concat decodes to the wrong length');
+assert(Math.abs(new OggSeekIndex(cutOggOpus(joined, 1200)).duration - (joinedMs - 1200)) < 1e-6, 'Cut of a concat lost the later part');
+
+const index = new OggSeekIndex(ogg);
+assert(index.duration === 3000, 'Seek index reported the wrong duration');
+const pos = index.seek(2000);
+assert(pos.offset > 0 && pos.preRoll >= 3840, 'Seek did not leave decoder pre-roll');
+assert(new OggSeekIndex(index.save()).seek(2000).offset === pos.offset, 'Reloaded seek index differs');
+
+const farm = new EncoderFarm(48_000, 1, 4);
+const ids = [farm.add(24_000), farm.add(), farm.add()];
+farm.remove(ids[1]);
+const lengths = new Int32Array(4);
+const produced = farm.tickAll(Buffer.alloc(4 * farm.pcmStride), Buffer.alloc(4 * farm.outStride), lengths);
+assert(produced === 2 && lengths[ids[1]] === 0, 'EncoderFarm did not skip the removed stream');
+assert.throws(() => new EncoderFarm(48_000, 1, 1 << 24), RangeError);
+
+const pool = new CodecPool({ threads: 2 });
+const otherPool = new CodecPool({ threads: 1 });
+const pending = Promise.all([0, 1, 2].map(() => pool.encode(opus, Buffer.alloc(320 * 2))));
+assert.throws(() => otherPool.encode(opus, Buffer.alloc(320 * 2)), /another CodecPool/);
+const pooled = await pending;
+assert(pooled.every((p) => p.length > 0), 'CodecPool returned an empty packet');
+assert(pool.stats().completed === 3, 'CodecPool did not count completed jobs');
+assert((await otherPool.encode(opus, Buffer.alloc(320 * 2))).length > 0, 'Encoder stayed bound to the first CodecPool');
+await Promise.all([pool.close(), otherPool.close()]);
+
+if (process.platform !== 'win32') {
+  const rawPath = path.join(os.tmpdir(), `pcm-ingest-${process.pid}.raw`);
+  fs.writeFileSync(rawPath, Buffer.alloc((48_000 + 480) * 2 * 2));
+  const batches = [];
+  const ingested = await new PcmIngest(rawPath, { batchFrames: 20 }).start((data, lengths) => batches.push(lengths.length));
+  assert(ingested.samples === 48_480 && ingested.frames === batches.reduce((a, b) => a + b, 0), 'PcmIngest lost frames');
+  assert(batches[0] === 20 && ingested.frames * 960 >= 48_480 + 312, 'PcmIngest did not batch or flush the tail');
+  fs.unlinkSync(rawPath);
+
+  // A FIFO nobody ever writes to: stop() and worker termination must not hang.
+  const fifoPath = path.join(os.tmpdir(), `pcm-ingest-${process.pid}.fifo`);
+  execFileSync('mkfifo', [fifoPath]);
+  const idle = new PcmIngest(fifoPath);
+  const idleDone = idle.start(() => {});
+  setTimeout(() => idle.stop(), 50);
+  assert((await idleDone).samples === 0, 'PcmIngest read from a FIFO with no writer');
+  const dist = pathToFileURL(path.join(import.meta.dirname, '../../dist/index.js')).href;
+  const worker = new Worker(
+    `import(${JSON.stringify(dist)}).then(({ PcmIngest }) => {
+      new PcmIngest(${JSON.stringify(fifoPath)}).start(() => {});
+      require('node:worker_threads').parentPort.postMessage('started');
+    });`,
+    { eval: true },
+  );
+  await once(worker, 'message');
+  await worker.terminate();
+  fs.unlinkSync(fifoPath);
+}
+
+if (process.platform !== 'win32') {
+  const recPath = path.join(os.tmpdir(), `ogg-recorder-${process.pid}.opus`);
+  const recorder = new OggRecorder({ flushIntervalMs: 60_000 });
+  const rec = recorder.open(recPath, { channels: 1, preSkip: 0 });
+  for (let i = 0; i < 3; i++) recorder.write(rec, opus.encode(Buffer.alloc(320 * 2)));
+  recorder.closeStream(rec);
+  await recorder.flush();
+  assert(new OggSeekIndex(fs.readFileSync(recPath)).duration === 60, 'OggRecorder wrote the wrong granules');
+  assert(recorder.stats().writeCalls === 1 && recorder.stats().streams === 0, 'OggRecorder did not batch its writes');
+  const rec2 = recorder.open(recPath, { channels: 1, preSkip: 0 });
+  recorder.write(rec2, opus.encode(Buffer.alloc(320 * 2)));
+  await recorder.close();
+  assert(new OggSeekIndex(fs.readFileSync(recPath)).duration === 20, 'OggRecorder.close() did not finish open streams');
+  fs.unlinkSync(recPath);
+}
+
+assert(new OpusEncoder(48_000, 1, { application: 'lowdelay' }).lookahead === 120, 'lowdelay lookahead is not 2.5 ms');
+assert(new OpusEncoder(48_000, 1).lookahead === 312, 'audio lookahead is not 6.5 ms');
+assert.throws(() => new OpusEncoder(48_000, 1, { application: 'music' }), RangeError);
+
+if (dnn) {
+  const dredEncoder = new OpusEncoder(16_000, 1, { application: 'voip' });
+  dredEncoder.applyEncoderCTL(4014, 20);
+  dredEncoder.setDredDuration(20);
+  const dredPacket = dredEncoder.encode(Buffer.alloc(320 * 2));
+  assert(dredEncoder.decodeDred(dredPacket, 2, 320).pcm.length === 2 * 320 * 2, 'decodeDred returned the wrong length');
+} else {
+  assert.throws(() => opus.setDredDuration(10), /opus_dnn/);
+}
+
+if (customModes) {
+  const custom = new OpusCustomEncoder(48_000, 1, 64);
+  assert(custom.delay === 128, 'Custom mode delay is not frame + overlap');
+  assert(custom.decode(custom.encode(Buffer.alloc(64 * 2))).length === 128, 'Custom mode round trip failed');
+  assert(custom.decode(null).length === 128, 'Custom mode PLC failed');
+} else {
+  assert.throws(() => new OpusCustomEncoder(48_000, 1, 64));
+}
+
+const ring = new PcmRing(new Uint8Array(new SharedArrayBuffer(PcmRing.byteLength(1024))));
+assert(ring.write(new Int16Array([1, 2, 3])), 'PcmRing rejected a record');
+assert(ring.read().equals(Buffer.from(new Int16Array([1, 2, 3]).buffer)), 'PcmRing returned a different record');
+assert(ring.read() === null, 'PcmRing should be empty');
+const ringMem = new Uint8Array(new SharedArrayBuffer(PcmRing.byteLength(1024)));
+const scribbled = new PcmRing(ringMem);
+scribbled.write(new Int16Array(4));
+new DataView(ringMem.buffer).setUint32(192, 1 << 20, true); // record length past the ring
+assert.throws(() => scribbled.read(), /corrupt/);
+
 console.log('Passed');
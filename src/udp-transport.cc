@@ -0,0 +1,587 @@
+// udp-transport.cc – sendmmsg/recvmmsg UDP transport for encoded packets.
+
+#include "udp-transport.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include "byte-view.h"
+#include "node-opus.h"
+#include "rtp.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <unistd.h>
+#endif
+
+static constexpr uint32_t kMaxBatch = 1024;    // messages per sendmmsg/recvmmsg
+static constexpr uint32_t kMaxGsoSegments = 64; // kernel limit is UDP_MAX_SEGMENTS (64/128)
+static constexpr size_t kMaxGsoBytes = 65000;
+static constexpr size_t kRecvStride = 1500;     // one MTU per received datagram
+
+#ifdef __linux__
+
+static bool ParseAddress(const std::string &host, int port, sockaddr_storage *out, socklen_t *len)
+{
+  std::memset(out, 0, sizeof(*out));
+  if (port < 0 || port > 65535)
+    return false;
+  sockaddr_in *v4 = reinterpret_cast<sockaddr_in *>(out);
+  if (inet_pton(AF_INET, host.c_str(), &v4->sin_addr) == 1)
+  {
+    v4->sin_family = AF_INET;
+    v4->sin_port = htons(static_cast<uint16_t>(port));
+    *len = sizeof(sockaddr_in);
+    return true;
+  }
+  sockaddr_in6 *v6 = reinterpret_cast<sockaddr_in6 *>(out);
+  if (inet_pton(AF_INET6, host.c_str(), &v6->sin6_addr) == 1)
+  {
+    v6->sin6_family = AF_INET6;
+    v6->sin6_port = htons(static_cast<uint16_t>(port));
+    *len = sizeof(sockaddr_in6);
+    return true;
+  }
+  return false;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// Constructor / destructor
+// new UdpTransport({ address = '0.0.0.0', port = 0, gso = true })
+// -----------------------------------------------------------------------------
+UdpTransportWrap::UdpTransportWrap(const Napi::CallbackInfo &info) : Napi::ObjectWrap<UdpTransportWrap>(info)
+{
+  Napi::Env env = info.Env();
+#ifdef __linux__
+  std::string host = "0.0.0.0";
+  int port = 0;
+  bool gso = true;
+  if (info.Length() > 0 && info[0].IsObject())
+  {
+    Napi::Object o = info[0].As<Napi::Object>();
+    if (o.Get("address").IsString())
+      host = o.Get("address").ToString().Utf8Value();
+    if (o.Get("port").IsNumber())
+      port = o.Get("port").ToNumber().Int32Value();
+    if (o.Get("gso").IsBoolean())
+      gso = o.Get("gso").ToBoolean().Value();
+  }
+
+  sockaddr_storage addr;
+  socklen_t addrLen;
+  if (!ParseAddress(host, port, &addr, &addrLen))
+  {
+    Napi::RangeError::New(env, "Invalid bind address or port").ThrowAsJavaScriptException();
+    return;
+  }
+  family_ = addr.ss_family;
+  fd_ = socket(family_, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd_ < 0 || bind(fd_, reinterpret_cast<sockaddr *>(&addr), addrLen) != 0)
+  {
+    std::string msg = std::string("Failed to bind UDP socket: ") + std::strerror(errno);
+    if (fd_ >= 0)
+      ::close(fd_);
+    fd_ = -1;
+    Napi::Error::New(env, msg).ThrowAsJavaScriptException();
+    return;
+  }
+#ifdef UDP_SEGMENT
+  // Probe GSO support once; per‑message cmsgs are only attached if it works.
+  int seg = 0;
+  gso_ = gso && setsockopt(fd_, SOL_UDP, UDP_SEGMENT, &seg, sizeof(seg)) == 0;
+#else
+  (void)gso;
+#endif
+#else
+  Napi::Error::New(env, "UdpTransport is only available on Linux").ThrowAsJavaScriptException();
+#endif
+}
+
+UdpTransportWrap::~UdpTransportWrap()
+{
+#ifdef __linux__
+  if (fd_ >= 0)
+    ::close(fd_);
+#endif
+}
+
+bool UdpTransportWrap::CheckOpen(Napi::Env env)
+{
+  if (fd_ >= 0)
+    return true;
+  Napi::Error::New(env, "UdpTransport is closed").ThrowAsJavaScriptException();
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Peers and queueing
+// -----------------------------------------------------------------------------
+
+// addPeer(address, port) -> peer id
+Napi::Value UdpTransportWrap::AddPeer(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckOpen(env))
+    return env.Null();
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (address: string, port: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+#ifdef __linux__
+  sockaddr_storage addr;
+  socklen_t len;
+  if (!ParseAddress(info[0].ToString().Utf8Value(), info[1].ToNumber().Int32Value(), &addr, &len) || addr.ss_family != family_)
+  {
+    Napi::RangeError::New(env, "Invalid peer address, or address family differs from the socket").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  peers_.push_back(addr);
+  peerLens_.push_back(len);
+  peerErrors_.push_back(0);
+  return Napi::Number::New(env, static_cast<double>(peers_.size() - 1));
+#else
+  return env.Null();
+#endif
+}
+
+bool UdpTransportWrap::Enqueue(Napi::Env env, const unsigned char *data, size_t len, uint32_t peer)
+{
+#ifdef __linux__
+  if (peer >= peers_.size())
+  {
+    Napi::RangeError::New(env, "Unknown peer id").ThrowAsJavaScriptException();
+    return false;
+  }
+#endif
+  if (len > kMaxGsoBytes)
+  {
+    Napi::RangeError::New(env, "Datagram too large").ThrowAsJavaScriptException();
+    return false;
+  }
+  pending_.push_back({peer, static_cast<uint32_t>(arena_.size()), static_cast<uint32_t>(len)});
+  arena_.insert(arena_.end(), data, data + len);
+  return true;
+}
+
+// queue(packet, peer) -> packets queued
+Napi::Value UdpTransportWrap::Queue(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  ByteView view;
+  if (!CheckOpen(env))
+    return env.Null();
+  if (info.Length() < 2 || !GetByteView(env, info[0], &view) || !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "Expected (packet: Buffer | ArrayBufferView | ArrayBuffer, peer: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (view.length > 0 && !Enqueue(env, view.data, view.length, info[1].ToNumber().Uint32Value()))
+    return env.Null();
+  return Napi::Number::New(env, static_cast<double>(pending_.size()));
+}
+
+// queueSlab(outSlab, stride, lengths, peers: Int32Array) -> packets queued
+// Takes EncoderFarm.tickAll() output as is: slot i holds lengths[i] bytes for
+// peers[i]; empty slots and negative peers are skipped.
+Napi::Value UdpTransportWrap::QueueSlab(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  ByteView slab;
+  if (!CheckOpen(env))
+    return env.Null();
+  if (info.Length() < 4 || !GetByteView(env, info[0], &slab) || !info[1].IsNumber() || !info[2].IsTypedArray() ||
+      info[2].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array || !info[3].IsTypedArray() ||
+      info[3].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array)
+  {
+    Napi::TypeError::New(env, "Expected (slab: Buffer, stride: number, lengths: Int32Array, peers: Int32Array)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  size_t stride = info[1].ToNumber().Uint32Value();
+  Napi::Int32Array lengths = info[2].As<Napi::Int32Array>();
+  Napi::Int32Array peers = info[3].As<Napi::Int32Array>();
+  size_t n = std::min(lengths.ElementLength(), peers.ElementLength());
+  if (stride == 0 || slab.length < n * stride)
+  {
+    Napi::RangeError::New(env, "Slab must hold one stride per length").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  for (size_t i = 0; i < n; ++i)
+  {
+    int32_t len = lengths[i];
+    if (len <= 0 || peers[i] < 0)
+      continue;
+    if (static_cast<size_t>(len) > stride)
+    {
+      Napi::RangeError::New(env, "Packet length exceeds stride").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (!Enqueue(env, slab.data + i * stride, len, static_cast<uint32_t>(peers[i])))
+      return env.Null();
+  }
+  return Napi::Number::New(env, static_cast<double>(pending_.size()));
+}
+
+// -----------------------------------------------------------------------------
+// flush() -> packets sent
+// Consecutive packets to one peer with equal size (the last may be shorter)
+// become a single GSO message; everything goes out through sendmmsg(). On
+// EAGAIN the unsent tail stays queued for the next flush. A message the
+// kernel rejects (EHOSTUNREACH, ...) is dropped and counted against its peer;
+// flush() only throws if nothing at all could be sent.
+// -----------------------------------------------------------------------------
+Napi::Value UdpTransportWrap::Flush(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (!CheckOpen(env))
+    return env.Null();
+#ifdef __linux__
+  std::vector<mmsghdr> msgs;
+  std::vector<iovec> iovs(pending_.size());
+  std::vector<size_t> firstOf; // pending index of each message's first packet
+#ifdef UDP_SEGMENT
+  const size_t cmsgSpace = CMSG_SPACE(sizeof(uint16_t));
+#else
+  const size_t cmsgSpace = 0;
+#endif
+  std::vector<unsigned char> control;
+  msgs.reserve(pending_.size());
+  control.resize(pending_.size() * std::max<size_t>(cmsgSpace, 1));
+
+  for (size_t i = 0; i < pending_.size();)
+  {
+    const Pending &p = pending_[i];
+    size_t j = i + 1, bytes = p.length;
+    if (gso_)
+    {
+      while (j < pending_.size() && pending_[j].peer == p.peer && j - i < kMaxGsoSegments &&
+             bytes + pending_[j].length <= kMaxGsoBytes && pending_[j - 1].length == p.length && pending_[j].length <= p.length)
+        bytes += pending_[j++].length;
+    }
+    for (size_t k = i; k < j; ++k)
+      iovs[k] = {arena_.data() + pending_[k].offset, pending_[k].length};
+
+    mmsghdr m;
+    std::memset(&m, 0, sizeof(m));
+    m.msg_hdr.msg_name = &peers_[p.peer];
+    m.msg_hdr.msg_namelen = peerLens_[p.peer];
+    m.msg_hdr.msg_iov = &iovs[i];
+    m.msg_hdr.msg_iovlen = j - i;
+#ifdef UDP_SEGMENT
+    if (j - i > 1)
+    {
+      unsigned char *ctl = control.data() + msgs.size() * cmsgSpace;
+      m.msg_hdr.msg_control = ctl;
+      m.msg_hdr.msg_controllen = cmsgSpace;
+      cmsghdr *c = CMSG_FIRSTHDR(&m.msg_hdr);
+      c->cmsg_level = SOL_UDP;
+      c->cmsg_type = UDP_SEGMENT;
+      c->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      uint16_t segment = static_cast<uint16_t>(p.length);
+      std::memcpy(CMSG_DATA(c), &segment, sizeof(segment));
+      ++gsoMessages_;
+    }
+#endif
+    msgs.push_back(m);
+    firstOf.push_back(i);
+    i = j;
+  }
+
+  // Messages [0, doneMsgs) are sent or dropped. sendmmsg() only fails if the
+  // first message of the call fails, so a hard error is charged to that
+  // message's peer; it is dropped and the rest still go out.
+  size_t doneMsgs = 0, dropped = 0;
+  std::string error;
+  while (doneMsgs < msgs.size())
+  {
+    unsigned n = static_cast<unsigned>(std::min<size_t>(kMaxBatch, msgs.size() - doneMsgs));
+    int rc = sendmmsg(fd_, msgs.data() + doneMsgs, n, 0);
+    ++sendCalls_;
+    if (rc < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+      if ((errno == EIO || errno == EINVAL) && gso_)
+      {
+        // No GSO on this route/NIC after all: requeue the rest without it.
+        gso_ = false;
+        break;
+      }
+      error = std::string("sendmmsg failed: ") + std::strerror(errno);
+      const Pending &p = pending_[firstOf[doneMsgs]];
+      ++peerErrors_[p.peer];
+      ++sendErrors_;
+      dropped += msgs[doneMsgs].msg_hdr.msg_iovlen;
+      ++doneMsgs;
+      continue;
+    }
+    doneMsgs += static_cast<size_t>(rc);
+  }
+
+  const size_t donePackets = doneMsgs < firstOf.size() ? firstOf[doneMsgs] : pending_.size();
+  const size_t sentPackets = donePackets - dropped;
+  packetsSent_ += sentPackets;
+  if (donePackets == pending_.size())
+  {
+    pending_.clear();
+    arena_.clear();
+  }
+  else if (donePackets > 0)
+  {
+    // Keep the arena to what is still queued; offsets only ever grow.
+    pending_.erase(pending_.begin(), pending_.begin() + donePackets);
+    const uint32_t base = pending_.front().offset;
+    arena_.erase(arena_.begin(), arena_.begin() + base);
+    for (Pending &p : pending_)
+      p.offset -= base;
+  }
+  if (!error.empty())
+    lastError_ = error;
+  if (sentPackets == 0 && !error.empty())
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Number::New(env, static_cast<double>(sentPackets));
+#else
+  return env.Null();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Receiving
+// -----------------------------------------------------------------------------
+int UdpTransportWrap::ReceiveInto(unsigned char *slab, size_t stride, uint32_t maxPackets, int32_t *lengths)
+{
+#ifdef __linux__
+  std::vector<mmsghdr> msgs(std::min(maxPackets, kMaxBatch));
+  std::vector<iovec> iovs(msgs.size());
+  for (size_t i = 0; i < msgs.size(); ++i)
+  {
+    iovs[i] = {slab + i * stride, stride};
+    std::memset(&msgs[i], 0, sizeof(mmsghdr));
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  int rc;
+  do
+    rc = recvmmsg(fd_, msgs.data(), static_cast<unsigned>(msgs.size()), MSG_DONTWAIT, nullptr);
+  while (rc < 0 && errno == EINTR);
+  ++recvCalls_;
+  if (rc < 0)
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -errno;
+  for (int i = 0; i < rc; ++i)
+    lengths[i] = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) ? -1 : static_cast<int32_t>(msgs[i].msg_len);
+  packetsReceived_ += static_cast<uint64_t>(rc);
+  return rc;
+#else
+  return 0;
+#endif
+}
+
+// receive(slab, lengths: Int32Array, stride = 1500) -> datagrams received
+// Datagram i lands at slab[i * stride]; lengths[i] is its size (-1 if truncated).
+Napi::Value UdpTransportWrap::Receive(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  ByteView slab;
+  if (!CheckOpen(env))
+    return env.Null();
+  if (info.Length() < 2 || !GetByteView(env, info[0], &slab) || !info[1].IsTypedArray() ||
+      info[1].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array)
+  {
+    Napi::TypeError::New(env, "Expected (slab: Buffer, lengths: Int32Array, stride?: number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  size_t stride = info.Length() > 2 && info[2].IsNumber() ? info[2].ToNumber().Uint32Value() : kRecvStride;
+  Napi::Int32Array lengths = info[1].As<Napi::Int32Array>();
+  if (stride == 0)
+  {
+    Napi::RangeError::New(env, "stride must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  uint32_t slots = static_cast<uint32_t>(std::min(slab.length / stride, lengths.ElementLength()));
+  int rc = slots ? ReceiveInto(slab.data, stride, slots, lengths.Data()) : 0;
+  if (rc < 0)
+  {
+    Napi::Error::New(env, std::string("recvmmsg failed: ") + std::strerror(-rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Number::New(env, rc);
+}
+
+// receiveDecode(encoder, pcmSlab, samples: Int32Array, { rtp = true, maxPackets = 64 }?)
+//   -> packets decoded
+// Drains up to maxPackets datagrams and decodes them with the encoder's
+// decoder, in RTP sequence order within the batch when rtp is set. pcmSlab is
+// split into maxPackets equal slots; samples[i] is the per‑channel sample
+// count of slot i, or a negative libopus error.
+Napi::Value UdpTransportWrap::ReceiveDecode(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  OpusEncoderWrap *codec = info.Length() > 0 ? OpusEncoderWrap::FromValue(env, info[0]) : nullptr;
+  ByteView pcmSlab;
+  if (!CheckOpen(env))
+    return env.Null();
+  if (!codec || info.Length() < 3 || !GetByteView(env, info[1], &pcmSlab) || !info[2].IsTypedArray() ||
+      info[2].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array)
+  {
+    Napi::TypeError::New(env, "Expected (encoder: OpusEncoder, pcmSlab: Buffer, samples: Int32Array, options?: object)")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (codec->asyncPending_ != 0)
+  {
+    Napi::Error::New(env, "Encoder has pending async work").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  bool rtp = true;
+  uint32_t maxPackets = 64;
+  if (info.Length() > 3 && info[3].IsObject())
+  {
+    Napi::Object o = info[3].As<Napi::Object>();
+    if (o.Get("rtp").IsBoolean())
+      rtp = o.Get("rtp").ToBoolean().Value();
+    if (o.Get("maxPackets").IsNumber())
+      maxPackets = o.Get("maxPackets").ToNumber().Uint32Value();
+  }
+  Napi::Int32Array samples = info[2].As<Napi::Int32Array>();
+  const size_t frameBytes = static_cast<size_t>(codec->Channels()) * sizeof(opus_int16);
+  maxPackets = std::min<uint32_t>({maxPackets, kMaxBatch, static_cast<uint32_t>(samples.ElementLength())});
+  size_t slotBytes = maxPackets ? pcmSlab.length / maxPackets / frameBytes * frameBytes : 0;
+  if (maxPackets == 0 || slotBytes == 0)
+  {
+    Napi::RangeError::New(env, "pcmSlab and samples must have room for at least one packet").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  recvSlab_.resize(static_cast<size_t>(maxPackets) * kRecvStride);
+  recvLens_.resize(maxPackets);
+  int rc = ReceiveInto(recvSlab_.data(), kRecvStride, maxPackets, recvLens_.data());
+  if (rc < 0)
+  {
+    Napi::Error::New(env, std::string("recvmmsg failed: ") + std::strerror(-rc)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  struct Item
+  {
+    const unsigned char *data;
+    int32_t len;
+    uint16_t seq;
+  };
+  std::vector<Item> items;
+  items.reserve(rc);
+  for (int i = 0; i < rc; ++i)
+  {
+    const unsigned char *d = recvSlab_.data() + static_cast<size_t>(i) * kRecvStride;
+    int32_t len = recvLens_[i];
+    if (len < 0)
+      continue;
+    RtpHeader h;
+    if (rtp)
+    {
+      if (!ParseRtp(d, len, 1, &h))
+        continue;
+      items.push_back({d + h.payloadOffset, static_cast<int32_t>(h.payloadLength), h.sequence});
+    }
+    else
+    {
+      items.push_back({d, len, 0});
+    }
+  }
+  if (rtp && !items.empty())
+  {
+    // Reorder within the batch, wrap‑aware relative to the first arrival.
+    uint16_t base = items[0].seq;
+    std::stable_sort(items.begin(), items.end(), [base](const Item &a, const Item &b) {
+      return static_cast<int16_t>(a.seq - base) < static_cast<int16_t>(b.seq - base);
+    });
+  }
+
+  pcm_.resize(slotBytes / sizeof(opus_int16));
+  const int slotSamples = static_cast<int>(slotBytes / frameBytes);
+  for (size_t i = 0; i < items.size(); ++i)
+  {
+    int n = codec->DecodeInto(items[i].data, items[i].len, pcm_.data(), slotSamples);
+    samples[i] = n;
+    if (n > 0)
+      std::memcpy(pcmSlab.data + i * slotBytes, pcm_.data(), static_cast<size_t>(n) * frameBytes);
+  }
+  return Napi::Number::New(env, static_cast<double>(items.size()));
+}
+
+// -----------------------------------------------------------------------------
+// stats() / close() / port
+// -----------------------------------------------------------------------------
+Napi::Value UdpTransportWrap::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("packetsSent", Napi::Number::New(env, static_cast<double>(packetsSent_)));
+  stats.Set("packetsReceived", Napi::Number::New(env, static_cast<double>(packetsReceived_)));
+  stats.Set("sendCalls", Napi::Number::New(env, static_cast<double>(sendCalls_)));
+  stats.Set("recvCalls", Napi::Number::New(env, static_cast<double>(recvCalls_)));
+  stats.Set("gsoMessages", Napi::Number::New(env, static_cast<double>(gsoMessages_)));
+  stats.Set("gso", Napi::Boolean::New(env, gso_));
+  stats.Set("queued", Napi::Number::New(env, static_cast<double>(pending_.size())));
+  stats.Set("sendErrors", Napi::Number::New(env, static_cast<double>(sendErrors_)));
+  Napi::Array peerErrors = Napi::Array::New(env, peerErrors_.size());
+  for (size_t i = 0; i < peerErrors_.size(); ++i)
+    peerErrors.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(peerErrors_[i])));
+  stats.Set("peerErrors", peerErrors);
+  stats.Set("lastError", lastError_.empty() ? env.Null() : Napi::String::New(env, lastError_));
+  return stats;
+}
+
+Napi::Value UdpTransportWrap::Close(const Napi::CallbackInfo &info)
+{
+#ifdef __linux__
+  if (fd_ >= 0)
+    ::close(fd_);
+#endif
+  fd_ = -1;
+  pending_.clear();
+  arena_.clear();
+  return info.Env().Undefined();
+}
+
+Napi::Value UdpTransportWrap::GetPort(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+#ifdef __linux__
+  sockaddr_storage addr;
+  socklen_t len = sizeof(addr);
+  if (fd_ >= 0 && getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &len) == 0)
+    return Napi::Number::New(env, ntohs(addr.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6 *>(&addr)->sin6_port
+                                                                    : reinterpret_cast<sockaddr_in *>(&addr)->sin_port));
+#endif
+  return env.Null();
+}
+
+// -----------------------------------------------------------------------------
+// JS class registration
+// -----------------------------------------------------------------------------
+Napi::Object UdpTransportWrap::Init(Napi::Env env, Napi::Object exports)
+{
+  Napi::Function ctor = Napi::ObjectWrap<UdpTransportWrap>::DefineClass(env, "UdpTransport", {
+                                                                                                 InstanceMethod("addPeer", &UdpTransportWrap::AddPeer),
+                                                                                                 InstanceMethod("queue", &UdpTransportWrap::Queue),
+                                                                                                 InstanceMethod("queueSlab", &UdpTransportWrap::QueueSlab),
+                                                                                                 InstanceMethod("flush", &UdpTransportWrap::Flush),
+                                                                                                 InstanceMethod("receive", &UdpTransportWrap::Receive),
+                                                                                                 InstanceMethod("receiveDecode", &UdpTransportWrap::ReceiveDecode),
+                                                                                                 InstanceMethod("stats", &UdpTransportWrap::Stats),
+                                                                                                 InstanceMethod("close", &UdpTransportWrap::Close),
+                                                                                                 InstanceAccessor("port", &UdpTransportWrap::GetPort, nullptr),
+                                                                                             });
+  exports.Set("UdpTransport", ctor);
+  return exports;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <napi.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "opus-common.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// UdpTransport – batched UDP I/O for media packets (Linux).
+// Packets are queued natively (copied into an arena) and flushed with one
+// sendmmsg() per tick, coalescing equal‑size runs to the same peer with UDP
+// GSO where the kernel supports it. Receiving drains the socket with
+// recvmmsg() into a caller slab, or straight into an OpusEncoder's decoder.
+// Other platforms get the class, but every method throws.
+// -----------------------------------------------------------------------------
+class UdpTransportWrap : public Napi::ObjectWrap<UdpTransportWrap>
+{
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  UdpTransportWrap(const Napi::CallbackInfo &);
+  ~UdpTransportWrap();
+
+private:
+  // JS‑exposed methods
+  Napi::Value AddPeer(const Napi::CallbackInfo &);
+  Napi::Value Queue(const Napi::CallbackInfo &);
+  Napi::Value QueueSlab(const Napi::CallbackInfo &);
+  Napi::Value Flush(const Napi::CallbackInfo &);
+  Napi::Value Receive(const Napi::CallbackInfo &);
+  Napi::Value ReceiveDecode(const Napi::CallbackInfo &);
+  Napi::Value Stats(const Napi::CallbackInfo &);
+  Napi::Value Close(const Napi::CallbackInfo &);
+  Napi::Value GetPort(const Napi::CallbackInfo &);
+
+  // Helpers
+  bool CheckOpen(Napi::Env env);
+  bool Enqueue(Napi::Env env, const unsigned char *data, size_t len, uint32_t peer);
+  int ReceiveInto(unsigned char *slab, size_t stride, uint32_t maxPackets, int32_t *lengths);
+
+  struct Pending
+  {
+    uint32_t peer;
+    uint32_t offset; // into arena_
+    uint32_t length;
+  };
+
+  // Members
+  int fd_{-1};
+  int family_{0};
+  bool gso_{false};
+#ifdef __linux__
+  std::vector<sockaddr_storage> peers_;
+  std::vector<socklen_t> peerLens_;
+#endif
+  std::vector<uint64_t> peerErrors_; // messages dropped per peer
+  std::vector<unsigned char> arena_;
+  std::vector<Pending> pending_;
+  std::vector<unsigned char> recvSlab_; // for ReceiveDecode
+  std::vector<int32_t> recvLens_;
+  std::vector<opus_int16> pcm_;
+  uint64_t packetsSent_{0};
+  uint64_t packetsReceived_{0};
+  uint64_t sendCalls_{0};
+  uint64_t recvCalls_{0};
+  uint64_t gsoMessages_{0};
+  uint64_t sendErrors_{0};
+  std::string lastError_;
+};
@@ -0,0 +1,94 @@
+// worker-pool.cc – fork/join thread pool shared by the batch encoders.
+
+#include "worker-pool.h"
+
+WorkerPool::WorkerPool(unsigned threads)
+{
+  threads_.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i)
+    threads_.emplace_back(&WorkerPool::Loop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &t : threads_)
+    t.join();
+}
+
+WorkerPool &WorkerPool::Shared()
+{
+  static WorkerPool pool([] {
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 1 ? hw - 1 : 0u;
+  }());
+  return pool;
+}
+
+// -----------------------------------------------------------------------------
+// Run / drain
+// -----------------------------------------------------------------------------
+void WorkerPool::Run(size_t count, const std::function<void(size_t)> &fn)
+{
+  if (count == 0)
+    return;
+  if (count == 1 || threads_.empty())
+  {
+    for (size_t i = 0; i < count; ++i)
+      fn(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> runLk(runMu_);
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    // A worker that woke late for the previous job may still be draining it.
+    done_.wait(lk, [this] { return active_ == 0; });
+    job_ = &fn;
+    count_ = count;
+    next_.store(0, std::memory_order_relaxed);
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  Drain(&fn, count);
+
+  std::unique_lock<std::mutex> lk(mu_);
+  done_.wait(lk, [this] { return active_ == 0; });
+  job_ = nullptr;
+  count_ = 0;
+}
+
+void WorkerPool::Drain(const std::function<void(size_t)> *job, size_t count)
+{
+  for (size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count;
+       i = next_.fetch_add(1, std::memory_order_relaxed))
+    (*job)(i);
+}
+
+void WorkerPool::Loop()
+{
+  unsigned long long seen = 0;
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;)
+  {
+    wake_.wait(lk, [&] { return stop_ || generation_ != seen; });
+    if (stop_)
+      return;
+    seen = generation_;
+    const std::function<void(size_t)> *job = job_;
+    size_t count = count_;
+    if (!job)
+      continue; // job already finished before we woke up
+    ++active_;
+    lk.unlock();
+    Drain(job, count);
+    lk.lock();
+    if (--active_ == 0)
+      done_.notify_all();
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// WorkerPool – small fork/join pool for fanning one call out across cores.
+// Run() blocks until every index has been processed; the calling thread works
+// alongside the pool threads, so a pool of size 0 simply runs serially.
+// -----------------------------------------------------------------------------
+class WorkerPool
+{
+public:
+  explicit WorkerPool(unsigned threads);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  // Invoke fn(i) for every i in [0, count). Calls are serialized per pool.
+  void Run(size_t count, const std::function<void(size_t)> &fn);
+
+  unsigned Size() const { return static_cast<unsigned>(threads_.size()); }
+
+  // Process‑wide pool sized to the machine (hardware threads - 1).
+  static WorkerPool &Shared();
+
+private:
+  void Loop();
+  void Drain(const std::function<void(size_t)> *job, size_t count);
+
+  std::vector<std::thread> threads_;
+  std::mutex runMu_; // serializes Run() callers
+  std::mutex mu_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(size_t)> *job_{nullptr};
+  size_t count_{0};
+  std::atomic<size_t> next_{0};
+  unsigned active_{0};
+  unsigned long long generation_{0};
+  bool stop_{false};
+};